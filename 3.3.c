@@ -1,189 +1,119 @@
+// Build: gcc 3.3.c scheduler.c -pthread -o 3.3
 #include <stdio.h>
-#include <limits.h>
-
-// Define the Process structure
-typedef struct {
-    int id;   // Original index/ID
-    int at;   // Arrival Time
-    int bt;   // Burst Time (Original)
-    int rt;   // Remaining Time (for RR)
-    int ct;   // Completion Time
-    int wt;   // Waiting Time
-    int tat;  // Turnaround Time
-    int done; // Flag for completion (will not be heavily used in RR, but kept for consistency)
-} P;
-
-// Function to print the scheduling results table
-void print_results(P a[], int n, double avg_wt, double avg_tat) {
-    printf("\n--- Scheduling Results ---\n");
-    printf("+----+-----+-----+-----+-----+-----+\n");
-    printf("| ID | AT  | BT  | CT  | TAT | WT  |\n");
-    printf("+----+-----+-----+-----+-----+-----+\n");
-
-    for (int i = 0; i < n; i++) {
-        printf("| %2d | %3d | %3d | %3d | %3d | %3d |\n",
-               a[i].id, a[i].at, a[i].bt, a[i].ct, a[i].tat, a[i].wt);
+#include "scheduler.h"
+
+// Policies offered by this program (and run by default in batch mode)
+static const SchedPolicy *const MENU_POLICIES[] = { &SCHED_POLICY_FCFS, &SCHED_POLICY_RR, &SCHED_POLICY_MLFQ };
+#define NUM_MENU_POLICIES (int)(sizeof MENU_POLICIES / sizeof MENU_POLICIES[0])
+
+// Prompt for the MLFQ levels, their quanta and the boost period
+static int read_mlfq_params(SchedParams *prm) {
+    int levels, boost;
+    printf("Enter number of MLFQ levels (1-%d): ", SCHED_MLFQ_MAX_LEVELS);
+    if (scanf("%d", &levels) != 1 || levels < 1 || levels > SCHED_MLFQ_MAX_LEVELS) {
+        printf("\nInvalid number of levels.\n");
+        while (getchar() != '\n'); // Clear input buffer
+        return -1;
     }
-    printf("+----+-----+-----+-----+-----+-----+\n");
-    printf("Average Waiting Time:    %.2f\n", avg_wt);
-    printf("Average Turnaround Time: %.2f\n", avg_tat);
-    printf("---------------------------\n");
-}
-
-// Function to implement FCFS (First-Come, First-Served)
-void fcfs_schedule(P a[], int n) {
-    double aw = 0, atv = 0;
-    int t = 0; // Current time
-
-    // Sort by arrival time (AT).
-    for (int i = 0; i < n; i++) {
-        for (int j = i + 1; j < n; j++) {
-            if (a[j].at < a[i].at) {
-                P tP = a[i];
-                a[i] = a[j];
-                a[j] = tP;
-            }
+    for (int l = 0; l < levels; l++) {
+        int q;
+        printf("Quantum for level %d: ", l);
+        if (scanf("%d", &q) != 1 || q <= 0) {
+            printf("\nInvalid quantum. It must be positive.\n");
+            while (getchar() != '\n'); // Clear input buffer
+            return -1;
         }
+        prm->mlfq_quantum[l] = q;
     }
-
-    // Process scheduling
-    for (int i = 0; i < n; i++) {
-        if (t < a[i].at) {
-            t = a[i].at;
-        }
-
-        t += a[i].bt;               
-        a[i].ct = t;
-        a[i].tat = a[i].ct - a[i].at; 
-        a[i].wt = a[i].tat - a[i].bt;   
-
-        aw += a[i].wt;
-        atv += a[i].tat;
+    printf("Priority boost period (0 = never): ");
+    if (scanf("%d", &boost) != 1 || boost < 0) {
+        printf("\nInvalid boost period.\n");
+        while (getchar() != '\n'); // Clear input buffer
+        return -1;
     }
-
-    print_results(a, n, aw / n, atv / n);
+    prm->mlfq_levels = levels;
+    prm->mlfq_boost = boost;
+    return 0;
 }
 
-// Function to implement Round Robin (RR) Scheduling
-void rr_schedule(P a[], int n, int quantum) {
-    double aw = 0, atv = 0;
-    int t = 0;      // Current time
-    int done = 0;   // Number of completed processes
-    
-    // Initialize remaining time
-    for (int i = 0; i < n; i++) {
-        a[i].rt = a[i].bt; 
-    }
-    
-    // Simple implementation mimicking the original code's logic 
-    // by iterating through all processes repeatedly.
-    // NOTE: A proper Round Robin implementation usually uses a Queue (or circular array)
-    // for the ready processes, but this structure follows the logic of the source code.
-    
-    // Loop until all processes are done (using a safety limit like the original code's 100000)
-    // The loop condition is simplified to just check 'done < n'.
-    while (done < n) {
-        int moved = 0; // Flag to check if any process ran in this cycle
-        
-        for (int i = 0; i < n; i++) {
-            // Check if process has remaining time AND has arrived
-            if (a[i].rt > 0 && a[i].at <= t) {
-                // Determine run time: minimum of remaining time or quantum
-                int run = (a[i].rt < quantum) ? a[i].rt : quantum; 
-                
-                a[i].rt -= run;
-                t += run;
-                moved = 1;
-
-                if (a[i].rt == 0) {
-                    // Process finished
-                    a[i].ct = t;
-                    done++;
+// Main menu-driven function with continuous loop
+// Given arguments (e.g. "-f trace.txt") it runs in batch mode instead of the menu.
+int main(int argc, char *argv[]) {
+    SchedTrace tr;
+    SchedParams prm; // RR quantum, context-switch cost, MLFQ levels
 
-                    // Calculate TAT and WT
-                    a[i].tat = a[i].ct - a[i].at;
-                    a[i].wt = a[i].tat - a[i].bt;
-                    
-                    aw += a[i].wt;
-                    atv += a[i].tat;
-                }
-            }
-        }
-        
-        // If no process ran in the entire cycle (i.e., CPU was idle or waiting for arrival)
-        if (!moved) {
-            t++;
-            // Safety break: if time reaches an arbitrary large number, stop (optional)
-            if (t > 100000) break;
-        }
+    if (argc > 1) {
+        return sched_batch_main(argc, argv, MENU_POLICIES, NUM_MENU_POLICIES);
     }
 
-    print_results(a, n, aw / n, atv / n);
-}
-
-// Main menu-driven function with continuous loop
-int main() {
-    int n;
-    printf("Enter the number of processes (n): ");
-    if (scanf("%d", &n) != 1 || n <= 0) {
-        printf("Invalid number of processes.\n");
+    sched_params_init(&prm);
+    if (sched_read_processes(&tr) != 0) {
         return 1;
     }
 
-    P a[n];
-    P original_a[n]; 
-    int quantum = 2; // Time quantum for Round Robin
-
-    printf("Enter Arrival Time (AT) and Burst Time (BT) for each process:\n");
-    for (int i = 0; i < n; i++) {
-        printf("P%d (AT BT): ", i);
-        if (scanf("%d %d", &a[i].at, &a[i].bt) != 2 || a[i].bt <= 0) {
-            printf("Invalid time input. Burst Time must be positive.\n");
-            return 1;
-        }
-        a[i].id = i;
-        original_a[i] = a[i]; // Store initial data
-    }
-
-    printf("\nNote: Round Robin is implemented with a fixed quantum (q=%d).\n", quantum);
+    printf("\nNote: Round Robin starts with quantum q=%d and no context-switch cost (menu option 3 changes them).\n", prm.quantum);
 
     int choice;
     // The Main Continuous Loop
-    while (1) { 
+    while (1) {
         printf("\n--- CPU Scheduling Menu ---\n");
         printf("1. FCFS (First-Come, First-Served)\n");
-        printf("2. Round Robin (q=%d)\n", quantum);
-        printf("3. Exit Program\n");
-        printf("Enter your choice (1-3): ");
-        
+        printf("2. Round Robin (q=%d, switch cost=%d)\n", prm.quantum, prm.switch_cost);
+        printf("3. Set RR Quantum and Context-Switch Cost\n");
+        printf("4. MLFQ (%d levels, boost every %d)\n", prm.mlfq_levels, prm.mlfq_boost);
+        printf("5. Set MLFQ Levels, Quanta and Boost Period\n");
+        printf("6. Compare All Scheduling Policies\n");
+        printf("7. Exit Program\n");
+        printf("Enter your choice (1-7): ");
+
         if (scanf("%d", &choice) != 1) {
             printf("\nInvalid input. Please enter a number.\n");
             while (getchar() != '\n'); // Clear input buffer
-            continue; 
-        }
-
-        // Restore data from the original array for a clean run
-        for (int i = 0; i < n; i++) {
-            a[i] = original_a[i];
+            continue;
         }
 
+        // The trace is never modified by a run, so every algorithm
+        // sees the original process data without restoring a copy.
         switch (choice) {
             case 1:
                 printf("\n*** Selected: FCFS ***\n");
-                fcfs_schedule(a, n);
+                sched_simulate(&tr, MENU_POLICIES[0], &prm);
                 break;
             case 2:
-                printf("\n*** Selected: Round Robin (q=%d) ***\n", quantum);
-                rr_schedule(a, n, quantum);
+                printf("\n*** Selected: Round Robin (q=%d, switch cost=%d) ***\n", prm.quantum, prm.switch_cost);
+                sched_simulate(&tr, MENU_POLICIES[1], &prm);
+                break;
+            case 3: {
+                int q, cs;
+                printf("Enter quantum and context-switch cost (q cs): ");
+                if (scanf("%d %d", &q, &cs) != 2 || q <= 0 || cs < 0) {
+                    printf("\nInvalid values. Quantum must be positive and cost non-negative.\n");
+                    while (getchar() != '\n'); // Clear input buffer
+                    break;
+                }
+                prm.quantum = q;
+                prm.switch_cost = cs;
+                break;
+            }
+            case 4:
+                printf("\n*** Selected: MLFQ (%d levels, boost every %d) ***\n", prm.mlfq_levels, prm.mlfq_boost);
+                sched_simulate(&tr, MENU_POLICIES[2], &prm);
                 break;
-            case 3:
+            case 5:
+                read_mlfq_params(&prm);
+                break;
+            case 6:
+                sched_compare(&tr, &prm);
+                break;
+            case 7:
                 printf("\nExiting program. Goodbye!\n");
+                sched_trace_free(&tr);
                 return 0; // Terminate the program
             default:
-                printf("\nInvalid choice (%d). Please select 1, 2, or 3.\n", choice);
+                printf("\nInvalid choice (%d). Please select 1-7.\n", choice);
                 break;
         }
     }
-    
+
     return 0;
-}
\ No newline at end of file
+}
@@ -1,8 +1,15 @@
+// Build: gcc 4.1.c pcqueue.c -pthread -o 4.1
+//   ./4.1           semaphore version
+//   ./4.1 -r        lock-free ring version
+//   ./4.1 -m N:M    N bakers and M eaters on a lock-free multi-producer/multi-consumer queue
+//   ./4.1 -b        benchmark the queues without the sleeps (see pcqueue.c)
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 #include <semaphore.h>
 #include <unistd.h> // For usleep
+#include "pcqueue.h"
 
 // --- Configuration ---
 #define BUFFER_SIZE 5       // N: Max capacity of the Pizza Counter
@@ -87,10 +94,121 @@ void* joey_tribbiani_eater(void* arg) {
     return NULL;
 }
 
+// --- Lock-Free Version: the same counter as a single-producer/single-consumer ring ---
+// With exactly one baker and one eater, each index has a single writer, so
+// atomic loads and stores replace the mutex and both semaphores (pcqueue.c).
+PcSpscRing pizza_ring;
+
+void* mr_simpson_ring_baker(void* arg) {
+    (void)arg;
+    for (int pizza_num = 1; pizza_num <= ITEMS_TO_PROCESS; pizza_num++) {
+        printf("Producer (Simpson) baked: %d\n", pizza_num);
+        pc_spsc_put(&pizza_ring, pizza_num); // Waits while the counter is full
+        usleep(300000); // Simulate baking time (0.3s)
+    }
+    return NULL;
+}
+
+void* joey_tribbiani_ring_eater(void* arg) {
+    (void)arg;
+    for (int i = 0; i < ITEMS_TO_PROCESS; i++) {
+        int consumed_pizza = (int)pc_spsc_get(&pizza_ring); // Waits while the counter is empty
+        printf("Consumer (Joey) consumed: %d\n", consumed_pizza);
+        usleep(500000); // Simulate eating time (0.5s)
+    }
+    return NULL;
+}
+
+int run_ring_version(void) {
+    pthread_t producer_thread, consumer_thread;
+
+    // Publish every pizza at once: the demo hands them over one at a time.
+    // (The ring rounds BUFFER_SIZE up to a power of two, i.e. 8 slots.)
+    if (pc_spsc_init(&pizza_ring, BUFFER_SIZE, 1) != 0) {
+        perror("Ring initialization failed");
+        return 1;
+    }
+
+    printf("Starting Producer (Simpson) and Consumer (Joey) on the lock-free ring...\n");
+    pthread_create(&producer_thread, NULL, mr_simpson_ring_baker, NULL);
+    pthread_create(&consumer_thread, NULL, joey_tribbiani_ring_eater, NULL);
+    pthread_join(producer_thread, NULL);
+    pthread_join(consumer_thread, NULL);
+    pc_spsc_destroy(&pizza_ring);
+
+    printf("\nAll %d pizzas have been baked and consumed. Synchronization successful!\n", ITEMS_TO_PROCESS);
+    return 0;
+}
+
+// --- Many Bakers and Eaters: a lock-free multi-producer/multi-consumer queue ---
+#define MAX_BAKERS 64
+#define NO_MORE_PIZZA 0 // Handed to each eater once all bakers are done
+
+PcMpmcQueue pizza_queue;
+int num_bakers;
+
+// Baker k bakes pizzas k+1, k+1+N, k+1+2N, ... so together they bake each number once
+void* simpson_family_baker(void* arg) {
+    int baker = (int)(long)arg;
+    for (int pizza_num = baker + 1; pizza_num <= ITEMS_TO_PROCESS; pizza_num += num_bakers) {
+        printf("Producer (Simpson %d) baked: %d\n", baker + 1, pizza_num);
+        pc_mpmc_put(&pizza_queue, pizza_num); // Sleeps while the counter is full
+        usleep(300000); // Simulate baking time (0.3s)
+    }
+    return NULL;
+}
+
+void* friends_eater(void* arg) {
+    int eater = (int)(long)arg;
+    int consumed_pizza;
+    while ((consumed_pizza = (int)pc_mpmc_get(&pizza_queue)) != NO_MORE_PIZZA) { // Sleeps while empty
+        printf("Consumer (Joey %d) consumed: %d\n", eater + 1, consumed_pizza);
+        usleep(500000); // Simulate eating time (0.5s)
+    }
+    return NULL;
+}
+
+int run_many_version(const char *spec) {
+    pthread_t bakers[MAX_BAKERS], eaters[MAX_BAKERS];
+    int num_eaters;
+
+    if (sscanf(spec, "%d:%d", &num_bakers, &num_eaters) != 2 || num_bakers < 1 || num_eaters < 1 ||
+        num_bakers > MAX_BAKERS || num_eaters > MAX_BAKERS) {
+        fprintf(stderr, "Expected BAKERS:EATERS, each 1..%d\n", MAX_BAKERS);
+        return 1;
+    }
+    // The queue rounds BUFFER_SIZE up to a power of two, i.e. 8 slots
+    if (pc_mpmc_init(&pizza_queue, BUFFER_SIZE) != 0) {
+        perror("Queue initialization failed");
+        return 1;
+    }
+
+    printf("Starting %d Producers (Simpsons) and %d Consumers (Joeys)...\n", num_bakers, num_eaters);
+    for (long i = 0; i < num_eaters; i++) pthread_create(&eaters[i], NULL, friends_eater, (void*)i);
+    for (long i = 0; i < num_bakers; i++) pthread_create(&bakers[i], NULL, simpson_family_baker, (void*)i);
+    for (int i = 0; i < num_bakers; i++) pthread_join(bakers[i], NULL);
+    for (int i = 0; i < num_eaters; i++) pc_mpmc_put(&pizza_queue, NO_MORE_PIZZA);
+    for (int i = 0; i < num_eaters; i++) pthread_join(eaters[i], NULL);
+    pc_mpmc_destroy(&pizza_queue);
+
+    printf("\nAll %d pizzas have been baked and consumed. Synchronization successful!\n", ITEMS_TO_PROCESS);
+    return 0;
+}
+
 // --- Main Function ---
-int main() {
+int main(int argc, char *argv[]) {
     pthread_t producer_thread, consumer_thread;
 
+    if (argc == 2 && strcmp(argv[1], "-r") == 0) {
+        return run_ring_version();
+    }
+    if (argc == 3 && strcmp(argv[1], "-m") == 0) {
+        return run_many_version(argv[2]);
+    }
+    if (argc > 1) {
+        return pc_batch_main(argc, argv);
+    }
+
     // 1. Initialize Synchronization Variables:
     // Initialize mutex (simplest way)
     if (pthread_mutex_init(&counter_mutex, NULL) != 0) {
@@ -127,4 +245,4 @@ int main() {
     printf("\nAll %d pizzas have been baked and consumed. Synchronization successful!\n", ITEMS_TO_PROCESS);
 
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -1,10 +1,16 @@
 // file_producer_consumer.c — Final Solution for 4.3 (mutex + binary semaphores)
+// Build: gcc 4.3.c pcqueue.c -pthread -o 4.3
+//   ./4.3           stdio version
+//   ./4.3 -m        memory-mapped ring version (producer and consumer threads)
+//   ./4.3 -p / -c   memory-mapped ring version as two processes; start both
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 #include <semaphore.h>
 #include <unistd.h>   // for usleep
 #include <time.h>     // for rand, srand
+#include "pcqueue.h"
 
 // --- Configuration ---
 #define TOTAL_ITEMS 50
@@ -87,10 +93,123 @@ void* consumer(void* arg) {
     return NULL;
 }
 
+// --- Memory-Mapped Ring Version ---
+// The numbers go into fixed-size slots of a ring laid out in RING_FILENAME
+// (header with head/tail, then the records; see pcqueue.c). Each side works
+// on the mapping directly, with no stdio or seeking, and up to RING_CAPACITY
+// numbers can be in flight instead of one.
+#define RING_FILENAME "nums.ring"
+#define RING_CAPACITY 8
+
+void* ring_producer(void* arg) {
+    PcFileRing* ring = arg;
+
+    printf("Producer started — generating %d random numbers (every 0.5s)...\n", TOTAL_ITEMS);
+
+    for (int i = 0; i < TOTAL_ITEMS; i++) {
+        usleep(500000); // fixed delay 0.5 seconds
+
+        int num = rand() % 10; // random number 0–9
+
+        // Write straight into the file's page; waits only if the ring is full
+        *(int*)pc_file_ring_reserve(ring) = num;
+        pc_file_ring_commit(ring);
+
+        printf("Producer: wrote %d\n", num);
+    }
+
+    pc_file_ring_close(ring); // Lets the consumer finish once it has read everything
+    printf("Producer finished.\n");
+    return NULL;
+}
+
+void* ring_consumer(void* arg) {
+    PcFileRing* ring = arg;
+    const int* slot;
+    int count = 0;
+
+    printf("Consumer started...\n");
+
+    // Waits while the ring is empty; NULL once the producer is done and it is drained
+    while ((slot = pc_file_ring_peek(ring)) != NULL) {
+        printf("Consumer: read %d\n", *slot);
+        pc_file_ring_release(ring);
+        count++;
+    }
+
+    printf("Consumer finished (%d numbers).\n", count);
+    return NULL;
+}
+
+int run_ring_threads(void) {
+    PcFileRing prod_ring, cons_ring; // Two mappings of the same file, one per side
+    pthread_t prod_thread, cons_thread;
+
+    if (pc_file_ring_create(&prod_ring, RING_FILENAME, RING_CAPACITY, sizeof(int)) != 0) return 1;
+    if (pc_file_ring_open(&cons_ring, RING_FILENAME) != 0) {
+        pc_file_ring_unmap(&prod_ring);
+        return 1;
+    }
+
+    pthread_create(&prod_thread, NULL, ring_producer, &prod_ring);
+    pthread_create(&cons_thread, NULL, ring_consumer, &cons_ring);
+    pthread_join(prod_thread, NULL);
+    pthread_join(cons_thread, NULL);
+
+    pc_file_ring_unmap(&prod_ring);
+    pc_file_ring_unmap(&cons_ring);
+    remove(RING_FILENAME);
+
+    printf("\nAll %d numbers produced and consumed successfully.\n", TOTAL_ITEMS);
+    return 0;
+}
+
+int run_ring_producer_process(void) {
+    PcFileRing ring;
+
+    if (pc_file_ring_create(&ring, RING_FILENAME, RING_CAPACITY, sizeof(int)) != 0) return 1;
+    ring_producer(&ring);
+    pc_file_ring_unmap(&ring);
+    return 0;
+}
+
+int run_ring_consumer_process(void) {
+    PcFileRing ring;
+
+    // The producer may not have created the ring yet (give it 30 seconds).
+    // A ring left over from an interrupted run is skipped: -p renames a new
+    // one over it, and this process would be left on the old file.
+    for (int tries = 0; ; tries++) {
+        if (access(RING_FILENAME, F_OK) == 0) {
+            if (pc_file_ring_open(&ring, RING_FILENAME) != 0) return 1;
+            if (!pc_file_ring_stale(&ring)) break;
+            pc_file_ring_unmap(&ring);
+        }
+        if (tries == 0) printf("Waiting for the producer (./4.3 -p) to create %s...\n", RING_FILENAME);
+        if (tries == 300) {
+            fprintf(stderr, "No producer started.\n");
+            return 1;
+        }
+        usleep(100000);
+    }
+    ring_consumer(&ring);
+    pc_file_ring_unmap(&ring);
+    remove(RING_FILENAME); // The consumer is the last one to use it
+    return 0;
+}
+
 // --- Main ---
-int main(void) {
+int main(int argc, char *argv[]) {
     srand(time(NULL)); // seed random generator
 
+    if (argc == 2 && strcmp(argv[1], "-m") == 0) return run_ring_threads();
+    if (argc == 2 && strcmp(argv[1], "-p") == 0) return run_ring_producer_process();
+    if (argc == 2 && strcmp(argv[1], "-c") == 0) return run_ring_consumer_process();
+    if (argc > 1) {
+        fprintf(stderr, "Usage: %s [-m | -p | -c]\n", argv[0]);
+        return 1;
+    }
+
     pthread_t prod_thread, cons_thread;
 
     // Initialize synchronization primitives
@@ -114,4 +233,4 @@ int main(void) {
     printf("\nAll %d numbers produced and consumed successfully.\n", TOTAL_ITEMS);
     // remove(FILENAME); // optional cleanup
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -1,9 +1,15 @@
 // readers_writers_reader_priority.c
+// Build: gcc 4.4.c rwlock.c -pthread -o 4.4
+//   ./4.4             reader priority, as below
+//   ./4.4 -l LOCK     the same run with reader, writer, fair or pthread (see rwlock.c)
+//   ./4.4 -b          benchmark the locks without the sleeps
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 #include <semaphore.h>
 #include <unistd.h>  // usleep
+#include "rwlock.h"
 
 // --- Configuration ---
 #define NUM_READERS 5
@@ -71,9 +77,78 @@ void* writer_activity(void* arg) {
     return NULL;
 }
 
-int main(void) {
+// --- The same reader and writer on a lock chosen at startup ---
+RwLock db_lock;
+
+void* reader_activity_rw(void* arg) {
+    int id = *(int*)arg;
+
+    for (int k = 0; k < ITERATIONS; k++) {
+        db_lock.pol->read_lock(&db_lock);
+        printf("Reader %d.%d: reading flight data = %d\n", id, k, flight_data);
+        usleep(100000); // ~0.1s reading
+        db_lock.pol->read_unlock(&db_lock);
+
+        usleep(50000); // ~0.05s between reads
+    }
+    return NULL;
+}
+
+void* writer_activity_rw(void* arg) {
+    int id = *(int*)arg;
+
+    for (int k = 0; k < ITERATIONS; k++) {
+        db_lock.pol->write_lock(&db_lock);
+        flight_data++; // e.g., book one seat
+        printf("Writer %d.%d: updated flight data -> %d\n", id, k, flight_data);
+        usleep(300000); // ~0.3s writing
+        db_lock.pol->write_unlock(&db_lock);
+
+        usleep(100000); // ~0.1s between writes
+    }
+    return NULL;
+}
+
+int run_with_lock(const char *name) {
     pthread_t rth[NUM_READERS], wth[NUM_WRITERS];
     int rid[NUM_READERS], wid[NUM_WRITERS];
+    const RwPolicy *pol = rw_policy_by_name(name);
+
+    if (!pol) return 1;
+    if (rw_init(&db_lock, pol) != 0) {
+        fprintf(stderr, "Could not initialize the %s lock\n", pol->title);
+        return 1;
+    }
+
+    printf("Airline Reservation System (%s) starting...\n", pol->title);
+
+    for (int i = 0; i < NUM_WRITERS; i++) {
+        wid[i] = i + 1;
+        pthread_create(&wth[i], NULL, writer_activity_rw, &wid[i]);
+    }
+    for (int i = 0; i < NUM_READERS; i++) {
+        rid[i] = i + 1;
+        pthread_create(&rth[i], NULL, reader_activity_rw, &rid[i]);
+    }
+    for (int i = 0; i < NUM_READERS; i++) pthread_join(rth[i], NULL);
+    for (int i = 0; i < NUM_WRITERS; i++) pthread_join(wth[i], NULL);
+
+    rw_destroy(&db_lock);
+
+    printf("\nSimulation complete. Final flight data: %d\n", flight_data);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    pthread_t rth[NUM_READERS], wth[NUM_WRITERS];
+    int rid[NUM_READERS], wid[NUM_WRITERS];
+
+    if (argc == 3 && strcmp(argv[1], "-l") == 0) {
+        return run_with_lock(argv[2]);
+    }
+    if (argc > 1) {
+        return rw_batch_main(argc, argv);
+    }
 
     // Init sync
     if (pthread_mutex_init(&read_count_mutex, NULL) != 0) {
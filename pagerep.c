@@ -0,0 +1,2376 @@
+// pagerep.c — page replacement reference loop and built-in policies
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>  // toupper
+#include <limits.h>
+#include <stdint.h>
+#include <fcntl.h>    // open
+#include <unistd.h>   // close, getopt
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>     // clock_gettime
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // SSE2/AVX2 frame scans
+#endif
+#include "pagerep.h"
+
+#define PAGEMAP_EMPTY INT_MIN // Not a valid page number
+
+// ===================================================================
+// Page -> frame hash table
+// ===================================================================
+
+// The table is sized once for the number of frames and kept at most half
+// full, so probe sequences stay short and it never needs to grow.
+int pagemap_init(PageMap *m, int capacity) {
+    unsigned slots = 16;
+    int bits = 4;
+    while (slots < 2u * (unsigned)capacity && slots < (1u << 31)) {
+        slots <<= 1;
+        bits++;
+    }
+    m->page = malloc(slots * sizeof *m->page);
+    m->frame = malloc(slots * sizeof *m->frame);
+    if (!m->page || !m->frame) {
+        pagemap_free(m);
+        return -1;
+    }
+    for (unsigned i = 0; i < slots; i++) m->page[i] = PAGEMAP_EMPTY;
+    m->mask = slots - 1;
+    m->shift = 32 - bits;
+    return 0;
+}
+
+void pagemap_free(PageMap *m) {
+    free(m->page);
+    free(m->frame);
+    m->page = NULL;
+    m->frame = NULL;
+}
+
+// Fibonacci hashing: the top bits of page * 2^32/phi spread consecutive pages
+static unsigned pagemap_home(const PageMap *m, int page) {
+    return ((unsigned)page * 2654435769u) >> m->shift;
+}
+
+int pagemap_get(const PageMap *m, int page) {
+    for (unsigned i = pagemap_home(m, page);; i = (i + 1) & m->mask) {
+        if (m->page[i] == page) return m->frame[i];
+        if (m->page[i] == PAGEMAP_EMPTY) return -1;
+    }
+}
+
+void pagemap_put(PageMap *m, int page, int frame) {
+    unsigned i = pagemap_home(m, page);
+    while (m->page[i] != PAGEMAP_EMPTY && m->page[i] != page) i = (i + 1) & m->mask;
+    m->page[i] = page;
+    m->frame[i] = frame;
+}
+
+// Backward-shift deletion: later entries of the probe run move into the hole,
+// so lookups never need tombstones
+void pagemap_del(PageMap *m, int page) {
+    unsigned i = pagemap_home(m, page);
+    while (m->page[i] != page) {
+        if (m->page[i] == PAGEMAP_EMPTY) return;
+        i = (i + 1) & m->mask;
+    }
+    for (unsigned j = (i + 1) & m->mask; m->page[j] != PAGEMAP_EMPTY; j = (j + 1) & m->mask) {
+        unsigned home = pagemap_home(m, m->page[j]);
+        // Move entry j into the hole unless its home lies cyclically in (i, j]
+        if (((j - home) & m->mask) >= ((j - i) & m->mask)) {
+            m->page[i] = m->page[j];
+            m->frame[i] = m->frame[j];
+            i = j;
+        }
+    }
+    m->page[i] = PAGEMAP_EMPTY;
+}
+
+// ===================================================================
+// Policy building blocks
+// ===================================================================
+
+// --- Doubly linked list threaded through a node array (head = newest) ---
+// Nodes are frame numbers, plus extra ghost nodes for policies that remember
+// recently evicted pages.
+typedef struct {
+    int head;
+    int tail;
+    int size;
+} PageList;
+
+static void list_init(PageList *l) {
+    l->head = l->tail = -1;
+    l->size = 0;
+}
+
+static void list_push(PageList *l, int *prev, int *next, int x) {
+    prev[x] = -1;
+    next[x] = l->head;
+    if (l->head >= 0) prev[l->head] = x;
+    else l->tail = x;
+    l->head = x;
+    l->size++;
+}
+
+static void list_unlink(PageList *l, int *prev, int *next, int x) {
+    if (prev[x] >= 0) next[prev[x]] = next[x];
+    else l->head = next[x];
+    if (next[x] >= 0) prev[next[x]] = prev[x];
+    else l->tail = prev[x];
+    l->size--;
+}
+
+// --- Indexed min-heap of frames on (key, tie) ---
+typedef struct {
+    int *heap;      // Frames, smallest (key, tie) on top
+    int *pos;       // Heap position of each frame, -1 if absent
+    long long *key;
+    long long *tie;
+    int size;
+} FrameHeap;
+
+static int fheap_init(FrameHeap *h, int frames) {
+    h->heap = malloc(frames * sizeof *h->heap);
+    h->pos = malloc(frames * sizeof *h->pos);
+    h->key = malloc(frames * sizeof *h->key);
+    h->tie = malloc(frames * sizeof *h->tie);
+    h->size = 0;
+    if (!h->heap || !h->pos || !h->key || !h->tie) return -1;
+    for (int f = 0; f < frames; f++) h->pos[f] = -1;
+    return 0;
+}
+
+static void fheap_free(FrameHeap *h) {
+    free(h->heap);
+    free(h->pos);
+    free(h->key);
+    free(h->tie);
+}
+
+static int fheap_before(const FrameHeap *h, int a, int b) {
+    return h->key[a] != h->key[b] ? h->key[a] < h->key[b] : h->tie[a] < h->tie[b];
+}
+
+static void fheap_swap(FrameHeap *h, int i, int j) {
+    int t = h->heap[i];
+    h->heap[i] = h->heap[j];
+    h->heap[j] = t;
+    h->pos[h->heap[i]] = i;
+    h->pos[h->heap[j]] = j;
+}
+
+// Insert frame f, or restore the order after its key changed
+static void fheap_update(FrameHeap *h, int f) {
+    int i = h->pos[f];
+    if (i < 0) {
+        i = h->size++;
+        h->heap[i] = f;
+        h->pos[f] = i;
+    }
+    while (i > 0 && fheap_before(h, h->heap[i], h->heap[(i - 1) / 2])) {
+        fheap_swap(h, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    for (;;) {
+        int best = i, l = 2 * i + 1, r = l + 1;
+        if (l < h->size && fheap_before(h, h->heap[l], h->heap[best])) best = l;
+        if (r < h->size && fheap_before(h, h->heap[r], h->heap[best])) best = r;
+        if (best == i) break;
+        fheap_swap(h, i, best);
+        i = best;
+    }
+}
+
+// ===================================================================
+// Built-in policies
+// ===================================================================
+
+// --- FIFO: evict frames in the order they were filled ---
+static int fifo_init(PageSim *s) {
+    int *hand = malloc(sizeof *hand);
+    if (!hand) return -1;
+    *hand = 0;
+    s->state = hand;
+    return 0;
+}
+
+static void free_state(PageSim *s) {
+    free(s->state);
+}
+
+static void no_hit(PageSim *s, int f) {
+    (void)s;
+    (void)f;
+}
+
+static void no_load(PageSim *s, int f) {
+    (void)s;
+    (void)f;
+}
+
+// Frames were filled 0, 1, ..., so the oldest page is always the next frame round
+static int fifo_victim(PageSim *s, int page) {
+    int *hand = s->state;
+    int f = *hand;
+    (void)page;
+    *hand = (f + 1) % s->frames;
+    return f;
+}
+
+// --- LRU: recency list over the frames ---
+typedef struct {
+    int *prev;
+    int *next;
+    PageList list; // Most recently used first
+} Lru;
+
+static int lru_init(PageSim *s) {
+    Lru *l = calloc(1, sizeof *l);
+    if (!l) return -1;
+    s->state = l;
+    l->prev = malloc(s->frames * sizeof *l->prev);
+    l->next = malloc(s->frames * sizeof *l->next);
+    list_init(&l->list);
+    return l->prev && l->next ? 0 : -1;
+}
+
+static void lru_destroy(PageSim *s) {
+    Lru *l = s->state;
+    if (!l) return;
+    free(l->prev);
+    free(l->next);
+    free(l);
+}
+
+static void lru_hit(PageSim *s, int f) {
+    Lru *l = s->state;
+    if (l->list.head == f) return;
+    list_unlink(&l->list, l->prev, l->next, f);
+    list_push(&l->list, l->prev, l->next, f);
+}
+
+static int lru_victim(PageSim *s, int page) {
+    Lru *l = s->state;
+    int f = l->list.tail;
+    (void)page;
+    list_unlink(&l->list, l->prev, l->next, f);
+    return f;
+}
+
+static void lru_load(PageSim *s, int f) {
+    Lru *l = s->state;
+    list_push(&l->list, l->prev, l->next, f);
+}
+
+// --- OPT (Belady): evict the page whose next use lies furthest ahead ---
+// The next-use index of every reference is built once, by a backward sweep;
+// the frames sit in a heap on their page's next use (furthest on top, ties to
+// the lower frame number as the original look-ahead scan picked).
+typedef struct {
+    int *next; // Next-use index per reference
+    FrameHeap heap;
+} Opt;
+
+static int opt_init(PageSim *s) {
+    if (!s->ref) return -1;
+    Opt *o = calloc(1, sizeof *o);
+    if (!o) return -1;
+    s->state = o;
+    o->next = page_next_use(s->ref, s->n);
+    return o->next && fheap_init(&o->heap, s->frames) == 0 ? 0 : -1;
+}
+
+static void opt_destroy(PageSim *s) {
+    Opt *o = s->state;
+    if (!o) return;
+    free(o->next);
+    fheap_free(&o->heap);
+    free(o);
+}
+
+// Called on hits and loads alike: frame f's page is next used at next[t]
+static void opt_touch(PageSim *s, int f) {
+    Opt *o = s->state;
+    o->heap.key[f] = -(long long)o->next[s->t];
+    o->heap.tie[f] = f;
+    fheap_update(&o->heap, f);
+}
+
+static int opt_victim(PageSim *s, int page) {
+    Opt *o = s->state;
+    (void)page;
+    return o->heap.heap[0]; // Stays in the heap; opt_touch re-keys it
+}
+
+// --- CLOCK: reference bits and a hand sweeping the frames ---
+typedef struct {
+    unsigned char *referenced;
+    int hand;
+} Clock;
+
+static int clock_init(PageSim *s) {
+    Clock *c = calloc(1, sizeof *c);
+    if (!c) return -1;
+    s->state = c;
+    c->referenced = calloc(s->frames, 1);
+    return c->referenced ? 0 : -1;
+}
+
+static void clock_destroy(PageSim *s) {
+    Clock *c = s->state;
+    if (!c) return;
+    free(c->referenced);
+    free(c);
+}
+
+static void clock_touch(PageSim *s, int f) {
+    Clock *c = s->state;
+    c->referenced[f] = 1;
+}
+
+// Every bit is cleared at most once per set, so the sweep is amortized O(1)
+static int clock_victim(PageSim *s, int page) {
+    Clock *c = s->state;
+    (void)page;
+    while (c->referenced[c->hand]) {
+        c->referenced[c->hand] = 0;
+        c->hand = (c->hand + 1) % s->frames;
+    }
+    int f = c->hand;
+    c->hand = (f + 1) % s->frames;
+    return f;
+}
+
+// --- Second chance: FIFO queue where referenced pages go round again ---
+// The textbook queue form of CLOCK; it evicts the same pages, which makes the
+// pair a cross-check of each other.
+typedef struct {
+    int *prev;
+    int *next;
+    PageList queue; // Newest first
+    unsigned char *referenced;
+} SecondChance;
+
+static int sc_init(PageSim *s) {
+    SecondChance *q = calloc(1, sizeof *q);
+    if (!q) return -1;
+    s->state = q;
+    q->prev = malloc(s->frames * sizeof *q->prev);
+    q->next = malloc(s->frames * sizeof *q->next);
+    q->referenced = calloc(s->frames, 1);
+    list_init(&q->queue);
+    return q->prev && q->next && q->referenced ? 0 : -1;
+}
+
+static void sc_destroy(PageSim *s) {
+    SecondChance *q = s->state;
+    if (!q) return;
+    free(q->prev);
+    free(q->next);
+    free(q->referenced);
+    free(q);
+}
+
+static void sc_hit(PageSim *s, int f) {
+    SecondChance *q = s->state;
+    q->referenced[f] = 1;
+}
+
+static int sc_victim(PageSim *s, int page) {
+    SecondChance *q = s->state;
+    (void)page;
+    for (;;) {
+        int f = q->queue.tail;
+        list_unlink(&q->queue, q->prev, q->next, f);
+        if (!q->referenced[f]) return f;
+        q->referenced[f] = 0;
+        list_push(&q->queue, q->prev, q->next, f);
+    }
+}
+
+static void sc_load(PageSim *s, int f) {
+    SecondChance *q = s->state;
+    q->referenced[f] = 1;
+    list_push(&q->queue, q->prev, q->next, f);
+}
+
+// --- LFU: evict the least frequently used page, the least recent on ties ---
+// Counts start again from 1 when a page is reloaded.
+typedef struct {
+    FrameHeap heap; // key = reference count, tie = time of the last reference
+} Lfu;
+
+static int lfu_init(PageSim *s) {
+    Lfu *l = calloc(1, sizeof *l);
+    if (!l) return -1;
+    s->state = l;
+    return fheap_init(&l->heap, s->frames);
+}
+
+static void lfu_destroy(PageSim *s) {
+    Lfu *l = s->state;
+    if (!l) return;
+    fheap_free(&l->heap);
+    free(l);
+}
+
+static void lfu_hit(PageSim *s, int f) {
+    Lfu *l = s->state;
+    l->heap.key[f]++;
+    l->heap.tie[f] = s->t;
+    fheap_update(&l->heap, f);
+}
+
+static int lfu_victim(PageSim *s, int page) {
+    Lfu *l = s->state;
+    (void)page;
+    return l->heap.heap[0];
+}
+
+static void lfu_load(PageSim *s, int f) {
+    Lfu *l = s->state;
+    l->heap.key[f] = 1;
+    l->heap.tie[f] = s->t;
+    fheap_update(&l->heap, f);
+}
+
+// --- Ghost lists: recently evicted pages, remembered without their frames ---
+// Shared by ARC and 2Q. Nodes 0..frames-1 are frames; nodes from 'frames' on
+// are ghost slots, handed out from a free stack.
+typedef struct {
+    int *prev;       // Links for every node (frames and ghosts)
+    int *next;
+    int *list;       // Which policy list each node is on
+    int *gpage;      // Page remembered by each ghost node
+    int *gfree;      // Free ghost nodes
+    int nfree;
+    PageMap ghosts;  // Ghost page -> node
+} Nodes;
+
+static int nodes_init(Nodes *nd, int frames, int nghosts) {
+    int total = frames + nghosts;
+    nd->prev = malloc(total * sizeof *nd->prev);
+    nd->next = malloc(total * sizeof *nd->next);
+    nd->list = malloc(total * sizeof *nd->list);
+    nd->gpage = malloc(total * sizeof *nd->gpage);
+    nd->gfree = malloc(nghosts * sizeof *nd->gfree);
+    nd->ghosts.page = nd->ghosts.frame = NULL;
+    if (!nd->prev || !nd->next || !nd->list || !nd->gpage || !nd->gfree ||
+        pagemap_init(&nd->ghosts, nghosts) != 0) {
+        return -1;
+    }
+    nd->nfree = 0;
+    for (int g = total - 1; g >= frames; g--) nd->gfree[nd->nfree++] = g;
+    return 0;
+}
+
+static void nodes_free(Nodes *nd) {
+    free(nd->prev);
+    free(nd->next);
+    free(nd->list);
+    free(nd->gpage);
+    free(nd->gfree);
+    pagemap_free(&nd->ghosts);
+}
+
+static void node_move(Nodes *nd, PageList lists[], int x, int to) {
+    list_unlink(&lists[nd->list[x]], nd->prev, nd->next, x);
+    nd->list[x] = to;
+    list_push(&lists[to], nd->prev, nd->next, x);
+}
+
+// Remember 'page' at the head of ghost list 'to'
+static void ghost_add(Nodes *nd, PageList lists[], int to, int page) {
+    int g = nd->gfree[--nd->nfree];
+    nd->gpage[g] = page;
+    nd->list[g] = to;
+    list_push(&lists[to], nd->prev, nd->next, g);
+    pagemap_put(&nd->ghosts, page, g);
+}
+
+static void ghost_drop(Nodes *nd, PageList lists[], int g) {
+    list_unlink(&lists[nd->list[g]], nd->prev, nd->next, g);
+    pagemap_del(&nd->ghosts, nd->gpage[g]);
+    nd->gfree[nd->nfree++] = g;
+}
+
+// --- ARC (Megiddo & Modha): adaptive split between recency and frequency ---
+// T1 holds pages seen once recently and T2 pages seen at least twice; B1/B2
+// remember what each evicted. A ghost hit in B1 (B2) grows (shrinks) the
+// target size p of T1, so the split adapts to the workload and one-off scans
+// cannot flush T2.
+enum { ARC_T1, ARC_T2, ARC_B1, ARC_B2 };
+
+typedef struct {
+    Nodes nd;
+    PageList lists[4];
+    int p;      // Target size of T1
+    int to_t2;  // The page being loaded was a ghost hit
+} Arc;
+
+static int arc_init(PageSim *s) {
+    Arc *a = calloc(1, sizeof *a);
+    if (!a) return -1;
+    s->state = a;
+    for (int i = 0; i < 4; i++) list_init(&a->lists[i]);
+    // B1 + B2 never exceed the frame count, plus one while a ghost hit is replaced
+    return nodes_init(&a->nd, s->frames, s->frames + 1);
+}
+
+static void arc_destroy(PageSim *s) {
+    Arc *a = s->state;
+    if (!a) return;
+    nodes_free(&a->nd);
+    free(a);
+}
+
+static void arc_hit(PageSim *s, int f) {
+    Arc *a = s->state;
+    node_move(&a->nd, a->lists, f, ARC_T2);
+}
+
+// Evict the LRU page of T1 or T2 into the matching ghost list
+static int arc_replace(PageSim *s, Arc *a, int in_b2) {
+    PageList *t1 = &a->lists[ARC_T1];
+    int from = ARC_T2, ghost = ARC_B2;
+    if (t1->size > 0 && ((in_b2 && t1->size == a->p) || t1->size > a->p || a->lists[ARC_T2].size == 0)) {
+        from = ARC_T1;
+        ghost = ARC_B1;
+    }
+    int f = a->lists[from].tail;
+    list_unlink(&a->lists[from], a->nd.prev, a->nd.next, f);
+    ghost_add(&a->nd, a->lists, ghost, s->frame[f]);
+    return f;
+}
+
+static int arc_victim(PageSim *s, int page) {
+    Arc *a = s->state;
+    PageList *l = a->lists;
+    int c = s->frames;
+    int g = pagemap_get(&a->nd.ghosts, page);
+    int f;
+
+    a->to_t2 = g >= 0;
+    if (g >= 0 && a->nd.list[g] == ARC_B1) {
+        int delta = l[ARC_B2].size / l[ARC_B1].size;
+        a->p = a->p + (delta > 1 ? delta : 1) < c ? a->p + (delta > 1 ? delta : 1) : c;
+        f = arc_replace(s, a, 0);
+        ghost_drop(&a->nd, l, g);
+    } else if (g >= 0) {
+        int delta = l[ARC_B1].size / l[ARC_B2].size;
+        a->p = a->p - (delta > 1 ? delta : 1) > 0 ? a->p - (delta > 1 ? delta : 1) : 0;
+        f = arc_replace(s, a, 1);
+        ghost_drop(&a->nd, l, g);
+    } else if (l[ARC_T1].size + l[ARC_B1].size == c) {
+        if (l[ARC_T1].size < c) {
+            ghost_drop(&a->nd, l, l[ARC_B1].tail);
+            f = arc_replace(s, a, 0);
+        } else {
+            // T1 alone fills the cache: its LRU page goes without a ghost
+            f = l[ARC_T1].tail;
+            list_unlink(&l[ARC_T1], a->nd.prev, a->nd.next, f);
+        }
+    } else {
+        if (l[ARC_T1].size + l[ARC_T2].size + l[ARC_B1].size + l[ARC_B2].size == 2 * c) {
+            ghost_drop(&a->nd, l, l[ARC_B2].tail);
+        }
+        f = arc_replace(s, a, 0);
+    }
+    return f;
+}
+
+static void arc_load(PageSim *s, int f) {
+    Arc *a = s->state;
+    int to = a->to_t2 ? ARC_T2 : ARC_T1;
+    a->nd.list[f] = to;
+    list_push(&a->lists[to], a->nd.prev, a->nd.next, f);
+    a->to_t2 = 0;
+}
+
+// --- 2Q (Johnson & Shasha): a FIFO probation queue in front of an LRU ---
+// New pages enter A1in; only pages referenced again after leaving it (found
+// in the ghost queue A1out) are promoted to the LRU list Am, so a scan of
+// one-off pages never disturbs Am. Sizes follow the paper: A1in holds a
+// quarter of the frames and A1out remembers half as many pages as frames.
+enum { Q2_A1IN, Q2_AM, Q2_A1OUT };
+
+typedef struct {
+    Nodes nd;
+    PageList lists[3];
+    int kin;    // Target size of A1in
+    int kout;   // Capacity of A1out
+    int to_am;  // The page being loaded was found in A1out
+} TwoQ;
+
+static int twoq_init(PageSim *s) {
+    TwoQ *q = calloc(1, sizeof *q);
+    if (!q) return -1;
+    s->state = q;
+    for (int i = 0; i < 3; i++) list_init(&q->lists[i]);
+    q->kin = s->frames / 4 > 1 ? s->frames / 4 : 1;
+    q->kout = s->frames / 2 > 1 ? s->frames / 2 : 1;
+    return nodes_init(&q->nd, s->frames, q->kout + 1);
+}
+
+static void twoq_destroy(PageSim *s) {
+    TwoQ *q = s->state;
+    if (!q) return;
+    nodes_free(&q->nd);
+    free(q);
+}
+
+// Hits in A1in leave it alone (a correlated burst is not a second use)
+static void twoq_hit(PageSim *s, int f) {
+    TwoQ *q = s->state;
+    if (q->nd.list[f] == Q2_AM) node_move(&q->nd, q->lists, f, Q2_AM);
+}
+
+static int twoq_victim(PageSim *s, int page) {
+    TwoQ *q = s->state;
+    PageList *l = q->lists;
+    int g = pagemap_get(&q->nd.ghosts, page);
+    int f;
+
+    q->to_am = g >= 0;
+    if (g >= 0) ghost_drop(&q->nd, l, g);
+
+    if (l[Q2_A1IN].size > q->kin || l[Q2_AM].size == 0) {
+        f = l[Q2_A1IN].tail;
+        list_unlink(&l[Q2_A1IN], q->nd.prev, q->nd.next, f);
+        ghost_add(&q->nd, l, Q2_A1OUT, s->frame[f]);
+        if (l[Q2_A1OUT].size > q->kout) ghost_drop(&q->nd, l, l[Q2_A1OUT].tail);
+    } else {
+        f = l[Q2_AM].tail;
+        list_unlink(&l[Q2_AM], q->nd.prev, q->nd.next, f);
+    }
+    return f;
+}
+
+static void twoq_load(PageSim *s, int f) {
+    TwoQ *q = s->state;
+    int to = q->to_am ? Q2_AM : Q2_A1IN;
+    q->nd.list[f] = to;
+    list_push(&q->lists[to], q->nd.prev, q->nd.next, f);
+    q->to_am = 0;
+}
+
+const PagePolicy PAGE_FIFO = {
+    "fifo", "FIFO",
+    fifo_init, free_state, no_hit, fifo_victim, no_load
+};
+
+const PagePolicy PAGE_LRU = {
+    "lru", "LRU",
+    lru_init, lru_destroy, lru_hit, lru_victim, lru_load
+};
+
+const PagePolicy PAGE_OPT = {
+    "opt", "Optimal",
+    opt_init, opt_destroy, opt_touch, opt_victim, opt_touch
+};
+
+const PagePolicy PAGE_CLOCK = {
+    "clock", "CLOCK",
+    clock_init, clock_destroy, clock_touch, clock_victim, clock_touch
+};
+
+const PagePolicy PAGE_SECOND_CHANCE = {
+    "sc", "Second Chance",
+    sc_init, sc_destroy, sc_hit, sc_victim, sc_load
+};
+
+const PagePolicy PAGE_LFU = {
+    "lfu", "LFU",
+    lfu_init, lfu_destroy, lfu_hit, lfu_victim, lfu_load
+};
+
+const PagePolicy PAGE_ARC = {
+    "arc", "ARC",
+    arc_init, arc_destroy, arc_hit, arc_victim, arc_load
+};
+
+const PagePolicy PAGE_2Q = {
+    "2q", "2Q",
+    twoq_init, twoq_destroy, twoq_hit, twoq_victim, twoq_load
+};
+
+const PagePolicy *const PAGE_POLICIES[] = {
+    &PAGE_FIFO, &PAGE_LRU, &PAGE_OPT, &PAGE_CLOCK, &PAGE_SECOND_CHANCE, &PAGE_LFU, &PAGE_ARC, &PAGE_2Q
+};
+const int PAGE_NUM_POLICIES = sizeof PAGE_POLICIES / sizeof PAGE_POLICIES[0];
+
+const PagePolicy *page_policy_by_name(const char *name) {
+    for (int i = 0; i < PAGE_NUM_POLICIES; i++) {
+        if (strcmp(PAGE_POLICIES[i]->name, name) == 0) return PAGE_POLICIES[i];
+    }
+    return NULL;
+}
+
+// ===================================================================
+// The reference loop
+// ===================================================================
+
+// --- Finding a resident page ---
+// Up to PAGE_SCAN_MAX_FRAMES frames, comparing the page against the whole
+// (cache-aligned) frame array beats hashing it: with SSE2 or AVX2 that is one
+// compare and movemask per 4 or 8 frames. Only the frames in use are
+// matched, so a page numbered -1 never finds an empty frame.
+static int find_scalar(const int *frame, int used, int page) {
+    for (int j = 0; j < used; j++) {
+        if (frame[j] == page) return j;
+    }
+    return -1;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+static int find_sse2(const int *frame, int used, int page) {
+    __m128i key = _mm_set1_epi32(page);
+    for (int j = 0; j < used; j += 4) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_load_si128((const __m128i *)(frame + j)), key);
+        unsigned m = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(eq));
+        if (used - j < 4) m &= (1u << (used - j)) - 1;
+        if (m) return j + __builtin_ctz(m);
+    }
+    return -1;
+}
+
+__attribute__((target("avx2")))
+static int find_avx2(const int *frame, int used, int page) {
+    __m256i key = _mm256_set1_epi32(page);
+    for (int j = 0; j < used; j += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_load_si256((const __m256i *)(frame + j)), key);
+        unsigned m = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        if (used - j < 8) m &= (1u << (used - j)) - 1;
+        if (m) return j + __builtin_ctz(m);
+    }
+    return -1;
+}
+#endif
+
+int page_lookup_supported(int lookup) {
+    switch (lookup) {
+        case PAGE_LOOKUP_HASH:
+        case PAGE_LOOKUP_SCALAR:
+            return 1;
+#if defined(__x86_64__) || defined(__i386__)
+        case PAGE_LOOKUP_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case PAGE_LOOKUP_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return 0;
+    }
+}
+
+const char *page_lookup_name(int lookup) {
+    static const char *const names[] = { "hash", "scalar", "SSE2", "AVX2" };
+    return lookup >= 0 && lookup <= PAGE_LOOKUP_AVX2 ? names[lookup] : "?";
+}
+
+static int frame_find(const PageSim *s, int page) {
+    switch (s->lookup) {
+        case PAGE_LOOKUP_SCALAR: return find_scalar(s->frame, s->used, page);
+#if defined(__x86_64__) || defined(__i386__)
+        case PAGE_LOOKUP_SSE2: return find_sse2(s->frame, s->used, page);
+        case PAGE_LOOKUP_AVX2: return find_avx2(s->frame, s->used, page);
+#endif
+        default: return pagemap_get(&s->map, page);
+    }
+}
+
+int page_sim_init(PageSim *s, const PagePolicy *pol, int frames, const int ref[], int n) {
+    memset(s, 0, sizeof *s);
+    s->pol = pol;
+    s->frames = frames;
+    s->ref = ref;
+    s->n = n;
+    s->evicted = -1;
+    // Whole cache lines, so the vector scans never read past the allocation
+    size_t bytes = ((size_t)frames * sizeof *s->frame + 63) & ~(size_t)63;
+    s->frame = aligned_alloc(64, bytes);
+    if (!s->frame || pagemap_init(&s->map, frames) != 0) {
+        free(s->frame);
+        return -1;
+    }
+    for (size_t i = 0; i < bytes / sizeof *s->frame; i++) s->frame[i] = -1;
+    s->lookup = PAGE_LOOKUP_HASH;
+    if (frames <= PAGE_SCAN_AUTO_FRAMES) {
+        for (int l = PAGE_LOOKUP_AVX2; l >= PAGE_LOOKUP_SCALAR && s->lookup == PAGE_LOOKUP_HASH; l--) {
+            if (page_lookup_supported(l)) s->lookup = l;
+        }
+    }
+    if (pol->init(s) != 0) {
+        page_sim_free(s);
+        return -1;
+    }
+    return 0;
+}
+
+void page_sim_free(PageSim *s) {
+    if (s->state) s->pol->destroy(s);
+    s->state = NULL;
+    free(s->frame);
+    s->frame = NULL;
+    pagemap_free(&s->map);
+}
+
+int page_access(PageSim *s, int page) {
+    const PagePolicy *pol = s->pol;
+    int hashed = s->lookup == PAGE_LOOKUP_HASH;
+    int f = frame_find(s, page);
+    s->evicted = -1;
+    if (f >= 0) {
+        pol->on_hit(s, f);
+        s->t++;
+        return 0;
+    }
+
+    // Fault: fill the next empty frame, or let the policy pick a victim
+    if (s->used < s->frames) {
+        f = s->used++;
+    } else {
+        f = pol->victim(s, page);
+        s->evicted = s->frame[f];
+        if (hashed) pagemap_del(&s->map, s->frame[f]);
+    }
+    s->frame[f] = page;
+    if (hashed) pagemap_put(&s->map, page, f);
+    pol->on_load(s, f);
+    s->faults++;
+    s->t++;
+    return 1;
+}
+
+// ===================================================================
+// Reference traces
+// ===================================================================
+
+int page_trace_open(PageTrace *t, const char *path) {
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    memset(t, 0, sizeof *t);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        fprintf(stderr, "%s: empty trace\n", path);
+        close(fd);
+        return -1;
+    }
+    t->size = st.st_size;
+    t->map = mmap(NULL, t->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid without the descriptor
+    if (t->map == MAP_FAILED) {
+        perror("mmap");
+        t->map = NULL;
+        return -1;
+    }
+    // Every pass reads the file front to back
+    madvise((void *)t->map, t->size, MADV_SEQUENTIAL);
+
+    PageTraceHeader h;
+    if (t->size >= sizeof h && memcmp(t->map, PAGE_TRACE_MAGIC, 4) == 0) {
+        memcpy(&h, t->map, sizeof h);
+        t->binary = 1;
+        t->count = h.count;
+        t->page_shift = h.page_shift;
+    } else {
+        // Text: count the references up front so callers can size arrays
+        int page;
+        t->count = 0;
+        page_trace_rewind(t);
+        while (page_trace_next(t, &page) == 1) t->count++;
+        if (t->error) {
+            fprintf(stderr, "%s: expected page numbers near byte %zu\n", path, (size_t)(t->p - t->map));
+            page_trace_close(t);
+            return -1;
+        }
+    }
+    // Only comments, or a binary header with nothing after it
+    if (t->count == 0) {
+        fprintf(stderr, "%s: empty trace\n", path);
+        page_trace_close(t);
+        return -1;
+    }
+    page_trace_rewind(t);
+    return 0;
+}
+
+void page_trace_rewind(PageTrace *t) {
+    t->p = t->map + (t->binary ? sizeof(PageTraceHeader) : 0);
+    t->end = t->map + t->size;
+    t->left = t->binary ? t->count : UINT64_MAX;
+    t->prev = 0;
+    t->error = 0;
+}
+
+// Binary: zigzag LEB128 varint of the difference from the previous page
+static int trace_next_binary(PageTrace *t, int *page) {
+    uint64_t v = 0;
+    int shift = 0;
+    for (;;) {
+        if (t->p == t->end || shift > 63) {
+            t->error = 1; // Truncated, or a varint too long to be ours
+            return -1;
+        }
+        unsigned char b = *t->p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) break;
+        shift += 7;
+    }
+    int64_t delta = (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    t->prev += delta;
+    if (t->prev < 0 || t->prev > INT_MAX) {
+        t->error = 1;
+        return -1;
+    }
+    *page = (int)t->prev;
+    return 1;
+}
+
+// Text: non-negative decimal page numbers separated by white space, with
+// '#' comments running to the end of the line
+static int trace_next_text(PageTrace *t, int *page) {
+    const unsigned char *p = t->p, *end = t->end;
+    for (;;) {
+        while (p < end && isspace(*p)) p++;
+        if (p < end && *p == '#') {
+            while (p < end && *p != '\n') p++;
+            continue;
+        }
+        break;
+    }
+    if (p == end) {
+        t->p = p;
+        return 0;
+    }
+    long long v = 0;
+    const unsigned char *start = p;
+    while (p < end && isdigit(*p) && v <= INT_MAX) v = v * 10 + (*p++ - '0');
+    t->p = p;
+    if (p == start || v > INT_MAX || (p < end && !isspace(*p) && *p != '#')) {
+        t->error = 1;
+        return -1;
+    }
+    *page = (int)v;
+    return 1;
+}
+
+int page_trace_next(PageTrace *t, int *page) {
+    if (!t->binary) return trace_next_text(t, page);
+    if (t->left == 0) return 0;
+    t->left--;
+    return trace_next_binary(t, page);
+}
+
+void page_trace_close(PageTrace *t) {
+    if (t->map) munmap((void *)t->map, t->size);
+    t->map = NULL;
+}
+
+int page_trace_load(const char *path, int **ref, int *n) {
+    PageTrace t;
+    if (page_trace_open(&t, path) != 0) return -1;
+    if (t.count > INT_MAX) {
+        fprintf(stderr, "%s: %llu references are too many to hold in memory at once\n",
+                path, (unsigned long long)t.count);
+        page_trace_close(&t);
+        return -1;
+    }
+    *n = (int)t.count;
+    *ref = malloc((*n ? *n : 1) * sizeof **ref);
+    if (!*ref) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        page_trace_close(&t);
+        return -1;
+    }
+    for (int i = 0; i < *n; i++) {
+        if (page_trace_next(&t, &(*ref)[i]) != 1) {
+            fprintf(stderr, "%s: truncated or corrupt trace at reference %d\n", path, i);
+            free(*ref);
+            page_trace_close(&t);
+            return -1;
+        }
+    }
+    page_trace_close(&t);
+    return 0;
+}
+
+// --- Writing binary traces ---
+int page_writer_open(PageTraceWriter *w, const char *path, int page_shift) {
+    PageTraceHeader h = { PAGE_TRACE_MAGIC, (uint32_t)page_shift, 0 };
+    w->f = fopen(path, "wb");
+    if (!w->f) {
+        perror(path);
+        return -1;
+    }
+    setvbuf(w->f, NULL, _IOFBF, 1 << 20);
+    w->prev = 0;
+    w->count = 0;
+    w->page_shift = page_shift;
+    fwrite(&h, sizeof h, 1, w->f); // The count is filled in by page_writer_close()
+    return 0;
+}
+
+void page_writer_put(PageTraceWriter *w, int page) {
+    unsigned char buf[10];
+    int len = 0;
+    int64_t delta = (int64_t)page - w->prev;
+    uint64_t v = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63); // Zigzag: small |delta| -> small v
+
+    do {
+        buf[len++] = (unsigned char)((v & 0x7f) | (v > 0x7f ? 0x80 : 0));
+        v >>= 7;
+    } while (v);
+    fwrite(buf, 1, len, w->f);
+    w->prev = page;
+    w->count++;
+}
+
+int page_writer_close(PageTraceWriter *w) {
+    PageTraceHeader h = { PAGE_TRACE_MAGIC, (uint32_t)w->page_shift, w->count };
+    int rc = 0;
+    if (fseek(w->f, 0, SEEK_SET) != 0 || fwrite(&h, sizeof h, 1, w->f) != 1) rc = -1;
+    if (ferror(w->f)) rc = -1;
+    if (fclose(w->f) != 0) rc = -1;
+    return rc;
+}
+
+// ===================================================================
+// Output
+// ===================================================================
+
+// Helper function to print the current state of the frames
+void print_frames(const int frame_array[], int frames, int page_fault) {
+    for (int j = 0; j < frames; j++) {
+        // Print -1 as '_' for a cleaner output
+        if (frame_array[j] == -1) {
+            printf("_ ");
+        } else {
+            printf("%d ", frame_array[j]);
+        }
+    }
+    printf("| %s\n", (page_fault ? "YES" : "NO"));
+}
+
+// Next reference from an in-memory string or, failing that, a trace file
+typedef struct {
+    const int *ref;
+    long long n;
+    long long i;
+    PageTrace *trace;
+} RefSource;
+
+static int source_next(RefSource *src, int *page) {
+    if (src->ref) {
+        if (src->i == src->n) return 0;
+        *page = src->ref[src->i++];
+        return 1;
+    }
+    return page_trace_next(src->trace, page);
+}
+
+// The whole string, if it is held in memory (OPT needs it)
+static const int *source_array(const RefSource *src, int *n) {
+    *n = (int)src->n;
+    return src->ref;
+}
+
+static void source_rewind(RefSource *src) {
+    src->i = 0;
+    if (src->trace) page_trace_rewind(src->trace);
+}
+
+// Every reference left in 'src', with nothing printed
+static void run_quiet(PageSim *s, RefSource *src) {
+    int page;
+    if (src->ref) {
+        for (; src->i < src->n; src->i++) page_access(s, src->ref[src->i]);
+        return;
+    }
+    while (page_trace_next(src->trace, &page) == 1) page_access(s, page);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// How simulate() reports a run
+typedef struct {
+    long long sample; // Print the frames after every sample-th reference (0 = never)
+    int timing;       // Report the simulation speed after the totals
+} SimOutput;
+
+// Run one policy over 'src', printing the classic table; returns the number
+// of faults (and the number of references in *total), or -1 on failure
+static long long simulate(const PagePolicy *pol, RefSource *src, int frames, const SimOutput *out,
+                          long long *total) {
+    PageSim s;
+    char upper[32];
+    size_t len = 0;
+    int n, page;
+    const int *ref = source_array(src, &n);
+
+    if (page_sim_init(&s, pol, frames, ref, n) != 0) {
+        printf("Memory allocation failed.\n");
+        return -1;
+    }
+    for (; pol->title[len] && len < sizeof upper - 1; len++) upper[len] = (char)toupper((unsigned char)pol->title[len]);
+    upper[len] = '\0';
+
+    printf("\n\n--- %s Algorithm Simulation (Frames: %d) ---\n", upper, frames);
+    double t0 = now_seconds();
+    if (out->sample == 0) {
+        run_quiet(&s, src);
+    } else {
+        printf("Page Reference | Frames | Page Fault\n");
+        printf("--------------------------------------------\n");
+        while (source_next(src, &page) == 1) {
+            int fault = page_access(&s, page);
+            // s.t has already moved past this reference
+            if ((s.t - 1) % out->sample == 0) {
+                printf("       %d         | ", page);
+                print_frames(s.frame, frames, fault);
+            }
+        }
+    }
+    double elapsed = now_seconds() - t0;
+
+    long long pages = s.t, page_faults = s.faults;
+    printf("--------------------------------------------\n");
+    printf("Total Page Faults (%s): %lld\n", pol->title, page_faults);
+    printf("Total Page Hits (%s):   %lld\n", pol->title, pages - page_faults);
+    printf("Hit Ratio (%s):         %.2f%%\n", pol->title, pages > 0 ? (float)(pages - page_faults) * 100 / pages : 0);
+    printf("Miss Ratio (%s):        %.2f%%\n", pol->title, pages > 0 ? (float)page_faults * 100 / pages : 0);
+    if (out->timing) printf("Simulated in %.3fs (%.0f refs/s)\n", elapsed, elapsed > 0 ? pages / elapsed : 0);
+
+    page_sim_free(&s);
+    *total = pages;
+    return page_faults;
+}
+
+int page_simulate(const PagePolicy *pol, const int ref[], int n, int frames) {
+    RefSource src = { ref, n, 0, NULL };
+    SimOutput out = { 1, 0 };
+    long long total;
+    return simulate(pol, &src, frames, &out, &total) < 0 ? -1 : 0;
+}
+
+static void comparison_header(int frames, long long n) {
+    printf("\n--- Policy Comparison (Frames: %d, References: %lld) ---\n", frames, n);
+    printf("+---------------+-------------+-----------+------------+\n");
+    printf("| Policy        | Page Faults | Hit Ratio | Miss Ratio |\n");
+    printf("+---------------+-------------+-----------+------------+\n");
+}
+
+static void comparison_row(const PagePolicy *pol, long long faults, long long n) {
+    printf("| %-13s | %11lld | %8.2f%% | %9.2f%% |\n", pol->title, faults,
+           n > 0 ? (float)(n - faults) * 100 / n : 0, n > 0 ? (float)faults * 100 / n : 0);
+}
+
+static void comparison_footer(void) {
+    printf("+---------------+-------------+-----------+------------+\n");
+}
+
+void page_compare(const int ref[], int n, int frames) {
+    comparison_header(frames, n);
+    for (int i = 0; i < PAGE_NUM_POLICIES; i++) {
+        PageSim s;
+        if (page_sim_init(&s, PAGE_POLICIES[i], frames, ref, n) != 0) {
+            printf("Memory allocation failed.\n");
+            return;
+        }
+        for (int j = 0; j < n; j++) page_access(&s, ref[j]);
+        comparison_row(PAGE_POLICIES[i], s.faults, n);
+        page_sim_free(&s);
+    }
+    comparison_footer();
+}
+
+void print_miss_ratio_curve(const int ref_string[], int pages) {
+    int distinct;
+    long long *hist = page_stack_distances(ref_string, pages, &distinct);
+    if (!hist) {
+        printf("Memory allocation failed.\n");
+        return;
+    }
+
+    printf("\n\n--- LRU Miss-Ratio Curve (Stack Distances, %d distinct pages) ---\n", distinct);
+    printf("Frames | Page Faults | Miss Ratio\n");
+    printf("--------------------------------------------\n");
+
+    // LRU with f frames misses the cold references and every reference at
+    // stack distance > f; beyond 'distinct' frames only cold misses remain
+    long long faults = pages;
+    for (int f = 1; f <= distinct; f++) {
+        faults -= hist[f];
+        printf("  %3d  |  %8lld   | %6.2f%%\n", f, faults, (float)faults * 100 / pages);
+    }
+    printf("--------------------------------------------\n");
+
+    free(hist);
+}
+
+// ===================================================================
+// Parameter sweep
+// ===================================================================
+
+// Workers share the reference string (read-only) and claim cells in order
+typedef struct {
+    const int *ref;
+    int n;
+    PageSweepJob *jobs;
+    int njobs;
+    int next; // Next unclaimed cell (atomic)
+} Sweep;
+
+static void *sweep_worker(void *arg) {
+    Sweep *sw = arg;
+    int i;
+    while ((i = __atomic_fetch_add(&sw->next, 1, __ATOMIC_RELAXED)) < sw->njobs) {
+        PageSweepJob *job = &sw->jobs[i];
+        PageSim s;
+        double t0 = now_seconds();
+        job->rc = page_sim_init(&s, job->pol, job->frames, sw->ref, sw->n);
+        if (job->rc == 0) {
+            for (int j = 0; j < sw->n; j++) page_access(&s, sw->ref[j]);
+            job->faults = s.faults;
+            page_sim_free(&s);
+        }
+        job->elapsed = now_seconds() - t0;
+    }
+    return NULL;
+}
+
+int page_sweep(const int ref[], int n, PageSweepJob *jobs, int njobs, int threads) {
+    Sweep sw = { ref, n, jobs, njobs, 0 };
+    pthread_t tid[PAGE_MAX_SWEEP_THREADS];
+    int started = 0;
+
+    if (threads > njobs) threads = njobs;
+    if (threads > PAGE_MAX_SWEEP_THREADS) threads = PAGE_MAX_SWEEP_THREADS;
+    // The calling thread is the last worker; if a thread can't be created
+    // the remaining ones simply take more cells each
+    while (started < threads - 1 && pthread_create(&tid[started], NULL, sweep_worker, &sw) == 0) {
+        started++;
+    }
+    sweep_worker(&sw);
+    for (int i = 0; i < started; i++) pthread_join(tid[i], NULL);
+
+    for (int i = 0; i < njobs; i++) {
+        if (jobs[i].rc != 0) return -1;
+    }
+    return 0;
+}
+
+// One row per frame count, one column per policy
+static void matrix_print(const PageSweepJob *jobs, int nframes, int npols, int n, int threads, double secs) {
+    printf("\n--- Policy x Frames Matrix (References: %d; %d runs on %d threads in %.2fs) ---\n",
+           n, nframes * npols, threads, secs);
+    printf("Page faults (miss ratio)\n");
+    for (int pass = 0; pass < 3; pass++) {
+        if (pass == 1) {
+            printf("| Frames |");
+            for (int j = 0; j < npols; j++) printf(" %-17s |", jobs[j].pol->title);
+            printf("\n");
+        } else {
+            printf("+--------+");
+            for (int j = 0; j < npols; j++) printf("-------------------+");
+            printf("\n");
+        }
+    }
+    for (int i = 0; i < nframes; i++) {
+        const PageSweepJob *row = &jobs[i * npols];
+        printf("| %6d |", row[0].frames);
+        for (int j = 0; j < npols; j++) {
+            printf(" %8lld (%5.1f%%) |", row[j].faults, n > 0 ? (float)row[j].faults * 100 / n : 0);
+        }
+        printf("\n");
+    }
+    printf("+--------+");
+    for (int j = 0; j < npols; j++) printf("-------------------+");
+    printf("\n");
+}
+
+// Run the policies x frame counts grid in parallel over the whole string
+static int batch_matrix(const PagePolicy *const pols[], int npols, const int frames[], int nframes,
+                        const int ref[], int n, int threads) {
+    PageSweepJob *jobs = malloc(npols * nframes * sizeof *jobs);
+    if (!jobs) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return 1;
+    }
+    for (int i = 0; i < nframes; i++) {
+        for (int j = 0; j < npols; j++) {
+            jobs[i * npols + j].pol = pols[j];
+            jobs[i * npols + j].frames = frames[i];
+        }
+    }
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+    if (threads > npols * nframes) threads = npols * nframes;
+
+    double t0 = now_seconds();
+    if (page_sweep(ref, n, jobs, npols * nframes, threads) != 0) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        free(jobs);
+        return 1;
+    }
+    matrix_print(jobs, nframes, npols, n, threads, now_seconds() - t0);
+    free(jobs);
+    return 0;
+}
+
+// ===================================================================
+// Several processes sharing the frames
+// ===================================================================
+
+enum { PROC_RUNNING, PROC_SUSPENDED, PROC_DONE };
+
+typedef struct {
+    PageTrace *trace;
+    int state;            // PROC_*
+    PageMap resident;     // Page -> frame
+    PageList lru;         // Its frames, most recently used first
+    PageMap in_window;    // Page -> references to it in the window
+    int *window;          // The last 'window' pages referenced (a ring)
+    int ws;               // Distinct pages in the window (the working set size)
+    int quota;            // Local allocation: frames it may hold
+    int need;             // Suspended: frames to free before it runs again
+    long long vt;         // Its own references so far (virtual time)
+    long long last_fault; // PFF: vt of the previous fault
+} VmProc;
+
+typedef struct {
+    const PageVmParams *prm;
+    VmProc *proc;
+    int nprocs;
+    int *owner;           // Process holding each frame, -1 if free
+    int *page;            // Page in each frame
+    long long *last_use;  // Owner's vt at the frame's last reference
+    int *gprev, *gnext;   // Global LRU list of all frames
+    int *lprev, *lnext;   // Each process's own list (a frame has one owner)
+    PageList global;
+    int *free_frame;      // Stack of free frames
+    int nfree;
+    PageVmResult *res;
+} Vm;
+
+static void vm_release(Vm *vm, int f) {
+    VmProc *p = &vm->proc[vm->owner[f]];
+    pagemap_del(&p->resident, vm->page[f]);
+    list_unlink(&p->lru, vm->lprev, vm->lnext, f);
+    list_unlink(&vm->global, vm->gprev, vm->gnext, f);
+    vm->owner[f] = -1;
+    vm->free_frame[vm->nfree++] = f;
+}
+
+// Load control: swap out the running process (other than 'self') holding the
+// most frames; returns 0 if there was none to swap out
+static int vm_suspend_one(Vm *vm, int self) {
+    int victim = -1;
+    for (int i = 0; i < vm->nprocs; i++) {
+        if (i != self && vm->proc[i].state == PROC_RUNNING && vm->proc[i].lru.size > 0 &&
+            (victim < 0 || vm->proc[i].lru.size > vm->proc[victim].lru.size)) {
+            victim = i;
+        }
+    }
+    if (victim < 0) return 0;
+    VmProc *q = &vm->proc[victim];
+    while (q->lru.size > 0) vm_release(vm, q->lru.tail);
+    q->state = PROC_SUSPENDED;
+    q->need = q->ws > 0 ? q->ws : 1;
+    vm->res->proc[victim].suspensions++;
+    vm->res->suspensions++;
+    return 1;
+}
+
+// A frame for process i's faulting page
+static int vm_frame_for(Vm *vm, int i) {
+    VmProc *p = &vm->proc[i];
+    switch (vm->prm->alloc) {
+        case PAGE_VM_GLOBAL:
+            if (vm->nfree == 0) vm_release(vm, vm->global.tail);
+            break;
+        case PAGE_VM_LOCAL:
+            if (p->lru.size >= p->quota) vm_release(vm, p->lru.tail);
+            break;
+        default:
+            // Working set and PFF: rather than take frames from a process that
+            // needs them, swap a whole process out
+            while (vm->nfree == 0 && !vm_suspend_one(vm, i)) vm_release(vm, p->lru.tail);
+            break;
+    }
+    return vm->free_frame[--vm->nfree];
+}
+
+static void vm_touch(Vm *vm, VmProc *p, int f) {
+    list_unlink(&p->lru, vm->lprev, vm->lnext, f);
+    list_push(&p->lru, vm->lprev, vm->lnext, f);
+    list_unlink(&vm->global, vm->gprev, vm->gnext, f);
+    list_push(&vm->global, vm->gprev, vm->gnext, f);
+    vm->last_use[f] = p->vt;
+}
+
+// Process i references 'page'; returns 1 on a page fault
+static int vm_access(Vm *vm, int i, int page) {
+    VmProc *p = &vm->proc[i];
+    int fault = 0;
+    int f = pagemap_get(&p->resident, page);
+
+    if (f >= 0) {
+        vm_touch(vm, p, f);
+    } else {
+        fault = 1;
+        if (vm->prm->alloc == PAGE_VM_PFF) {
+            // Faults far apart mean the allocation is too large: drop every
+            // page not used since the previous fault
+            if (p->vt - p->last_fault > vm->prm->window) {
+                while (p->lru.size > 0 && vm->last_use[p->lru.tail] < p->last_fault) {
+                    vm_release(vm, p->lru.tail);
+                }
+            }
+            p->last_fault = p->vt;
+        }
+        f = vm_frame_for(vm, i);
+        vm->owner[f] = i;
+        vm->page[f] = page;
+        pagemap_put(&p->resident, page, f);
+        list_push(&p->lru, vm->lprev, vm->lnext, f);
+        list_push(&vm->global, vm->gprev, vm->gnext, f);
+        vm->last_use[f] = p->vt;
+    }
+
+    // Slide the window: the new page comes in before the oldest leaves, so a
+    // page referenced again never drops out
+    int w = vm->prm->window, slot = (int)(p->vt % w);
+    int c = pagemap_get(&p->in_window, page);
+    if (c < 0) {
+        pagemap_put(&p->in_window, page, 1);
+        p->ws++;
+    } else {
+        pagemap_put(&p->in_window, page, c + 1);
+    }
+    if (p->vt >= w) {
+        int old = p->window[slot];
+        c = pagemap_get(&p->in_window, old);
+        if (c > 1) {
+            pagemap_put(&p->in_window, old, c - 1);
+        } else {
+            pagemap_del(&p->in_window, old);
+            p->ws--;
+            // The working-set policy keeps exactly the window resident
+            if (vm->prm->alloc == PAGE_VM_WS && (f = pagemap_get(&p->resident, old)) >= 0) vm_release(vm, f);
+        }
+    }
+    p->window[slot] = page;
+    p->vt++;
+    return fault;
+}
+
+// Share the frames equally among the processes still running (local allocation)
+static void vm_partition(Vm *vm) {
+    int live = 0, k = 0;
+    for (int i = 0; i < vm->nprocs; i++) live += vm->proc[i].state != PROC_DONE;
+    for (int i = 0; i < vm->nprocs; i++) {
+        if (vm->proc[i].state == PROC_DONE) continue;
+        vm->proc[i].quota = vm->prm->frames / live + (k++ < vm->prm->frames % live);
+    }
+}
+
+static void vm_free(Vm *vm) {
+    for (int i = 0; i < vm->nprocs && vm->proc; i++) {
+        pagemap_free(&vm->proc[i].resident);
+        pagemap_free(&vm->proc[i].in_window);
+        free(vm->proc[i].window);
+    }
+    free(vm->proc);
+    free(vm->owner);
+    free(vm->page);
+    free(vm->last_use);
+    free(vm->gprev);
+    free(vm->gnext);
+    free(vm->lprev);
+    free(vm->lnext);
+    free(vm->free_frame);
+}
+
+static int vm_init(Vm *vm, PageTrace traces[], int nprocs, const PageVmParams *prm, PageVmResult *res) {
+    int frames = prm->frames;
+    memset(vm, 0, sizeof *vm);
+    vm->prm = prm;
+    vm->nprocs = nprocs;
+    vm->res = res;
+    vm->proc = calloc(nprocs, sizeof *vm->proc);
+    vm->owner = malloc(frames * sizeof *vm->owner);
+    vm->page = malloc(frames * sizeof *vm->page);
+    vm->last_use = malloc(frames * sizeof *vm->last_use);
+    vm->gprev = malloc(frames * sizeof *vm->gprev);
+    vm->gnext = malloc(frames * sizeof *vm->gnext);
+    vm->lprev = malloc(frames * sizeof *vm->lprev);
+    vm->lnext = malloc(frames * sizeof *vm->lnext);
+    vm->free_frame = malloc(frames * sizeof *vm->free_frame);
+    if (!vm->proc || !vm->owner || !vm->page || !vm->last_use || !vm->gprev || !vm->gnext || !vm->lprev ||
+        !vm->lnext || !vm->free_frame) {
+        return -1;
+    }
+    // Frames are handed out lowest first
+    for (int f = 0; f < frames; f++) {
+        vm->owner[f] = -1;
+        vm->free_frame[f] = frames - 1 - f;
+    }
+    vm->nfree = frames;
+    list_init(&vm->global);
+
+    for (int i = 0; i < nprocs; i++) {
+        VmProc *p = &vm->proc[i];
+        p->trace = &traces[i];
+        list_init(&p->lru);
+        p->window = malloc(prm->window * sizeof *p->window);
+        if (!p->window || pagemap_init(&p->resident, frames) != 0 || pagemap_init(&p->in_window, prm->window) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int page_vm_run(PageTrace traces[], int nprocs, const PageVmParams *prm, PageVmResult *res) {
+    Vm vm;
+    long long interval_faults = 0;
+    int live = nprocs, cur = 0, rc = 0;
+
+    memset(&vm, 0, sizeof vm);
+    memset(res, 0, sizeof *res);
+    res->nprocs = nprocs;
+    res->first_thrash = -1;
+    res->proc = calloc(nprocs, sizeof *res->proc);
+    if (!res->proc || vm_init(&vm, traces, nprocs, prm, res) != 0) {
+        vm_free(&vm);
+        page_vm_result_free(res);
+        return -1;
+    }
+    if (prm->alloc == PAGE_VM_LOCAL) vm_partition(&vm);
+
+    double t0 = now_seconds();
+    while (live > 0) {
+        // Bring swapped-out processes back once their working set fits
+        int running = 0;
+        for (int i = 0; i < nprocs; i++) {
+            VmProc *p = &vm.proc[i];
+            if (p->state == PROC_SUSPENDED && vm.nfree >= p->need) p->state = PROC_RUNNING;
+            running += p->state == PROC_RUNNING;
+        }
+        for (int i = 0; i < nprocs && running == 0; i++) {
+            if (vm.proc[i].state == PROC_SUSPENDED) {
+                vm.proc[i].state = PROC_RUNNING;
+                running = 1;
+            }
+        }
+
+        // Round robin: the next running process gets a quantum of references
+        while (vm.proc[cur].state != PROC_RUNNING) cur = (cur + 1) % nprocs;
+        VmProc *p = &vm.proc[cur];
+        PageVmProcStats *ps = &res->proc[cur];
+        for (int q = 0; q < prm->quantum; q++) {
+            int page, got = page_trace_next(p->trace, &page);
+            if (got != 1) {
+                if (got < 0) rc = -1;
+                while (p->lru.size > 0) vm_release(&vm, p->lru.tail);
+                p->state = PROC_DONE;
+                p->ws = 0;
+                live--;
+                if (prm->alloc == PAGE_VM_LOCAL && live > 0) vm_partition(&vm);
+                break;
+            }
+            int fault = vm_access(&vm, cur, page);
+            ps->refs++;
+            ps->faults += fault;
+            ps->rss_sum += p->lru.size;
+            if (p->ws > ps->max_ws) ps->max_ws = p->ws;
+            res->refs++;
+            res->faults += fault;
+            interval_faults += fault;
+
+            // Thrashing: the running processes' working sets no longer fit
+            if (res->refs % prm->interval == 0) {
+                long long demand = 0;
+                for (int i = 0; i < nprocs; i++) {
+                    if (vm.proc[i].state == PROC_RUNNING) demand += vm.proc[i].ws;
+                }
+                double rate = (double)interval_faults / prm->interval;
+                if (rate > res->peak_fault_rate) res->peak_fault_rate = rate;
+                res->intervals++;
+                if (demand > prm->frames) {
+                    res->thrashing++;
+                    if (res->first_thrash < 0) res->first_thrash = res->refs;
+                }
+                interval_faults = 0;
+            }
+        }
+        if (rc != 0) break;
+        cur = (cur + 1) % nprocs;
+    }
+    res->elapsed = now_seconds() - t0;
+
+    vm_free(&vm);
+    if (rc != 0) page_vm_result_free(res);
+    return rc;
+}
+
+void page_vm_result_free(PageVmResult *res) {
+    free(res->proc);
+    res->proc = NULL;
+}
+
+static const char *const VM_ALLOC_NAMES[] = { "global", "local", "ws", "pff" };
+static const char *const VM_ALLOC_TITLES[] = {
+    "Global LRU", "Local LRU (equal partitions)", "Working Set", "Page-Fault Frequency"
+};
+
+int page_vm_alloc_by_name(const char *name) {
+    for (int i = 0; i < (int)(sizeof VM_ALLOC_NAMES / sizeof VM_ALLOC_NAMES[0]); i++) {
+        if (strcmp(name, VM_ALLOC_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+void page_vm_print(const PageVmParams *prm, const PageVmResult *res) {
+    printf("\n--- %s: %d Processes, %d Frames (window %d, quantum %d) ---\n", VM_ALLOC_TITLES[prm->alloc],
+           res->nprocs, prm->frames, prm->window, prm->quantum);
+    printf("+------+-------------+-------------+------------+---------------+--------+-------------+\n");
+    printf("| Proc | References  | Page Faults | Fault Rate | Mean Resident | Max WS | Suspensions |\n");
+    printf("+------+-------------+-------------+------------+---------------+--------+-------------+\n");
+    for (int i = 0; i < res->nprocs; i++) {
+        const PageVmProcStats *ps = &res->proc[i];
+        printf("| %4d | %11lld | %11lld | %9.2f%% | %13.1f | %6d | %11d |\n", i, ps->refs, ps->faults,
+               ps->refs > 0 ? (float)ps->faults * 100 / ps->refs : 0, ps->refs > 0 ? (double)ps->rss_sum / ps->refs : 0,
+               ps->max_ws, ps->suspensions);
+    }
+    printf("+------+-------------+-------------+------------+---------------+--------+-------------+\n");
+    printf("| All  | %11lld | %11lld | %9.2f%% |               |        | %11lld |\n", res->refs, res->faults,
+           res->refs > 0 ? (float)res->faults * 100 / res->refs : 0, res->suspensions);
+    printf("+------+-------------+-------------+------------+---------------+--------+-------------+\n");
+
+    if (res->thrashing > 0) {
+        printf("Thrashing: working sets exceeded the frames in %lld of %lld intervals (%.1f%%), first after %lld references\n",
+               res->thrashing, res->intervals, (float)res->thrashing * 100 / res->intervals, res->first_thrash);
+    } else {
+        printf("No thrashing: the working sets fit in every one of %lld intervals\n", res->intervals);
+    }
+    printf("Peak interval fault rate: %.2f%% (intervals of %lld references)\n", res->peak_fault_rate * 100,
+           prm->interval);
+    printf("Simulated in %.3fs (%.0f refs/s)\n", res->elapsed, res->elapsed > 0 ? res->refs / res->elapsed : 0);
+}
+
+// ===================================================================
+// Address translation
+// ===================================================================
+
+// Set-associative TLB; within a set the entry used longest ago is replaced
+typedef struct {
+    int *tag;         // Translation unit cached per entry, -1 if invalid
+    long long *stamp; // Last use per entry (0 = invalid, so replaced first)
+    int sets;
+    int ways;
+    long long clock;
+} Tlb;
+
+static int tlb_init(Tlb *tlb, int entries, int ways) {
+    tlb->ways = ways > 0 && ways < entries ? ways : entries;
+    tlb->sets = entries / tlb->ways;
+    tlb->clock = 0;
+    tlb->tag = malloc(tlb->sets * tlb->ways * sizeof *tlb->tag);
+    tlb->stamp = calloc(tlb->sets * tlb->ways, sizeof *tlb->stamp);
+    if (!tlb->tag || !tlb->stamp) {
+        free(tlb->tag);
+        free(tlb->stamp);
+        return -1;
+    }
+    for (int i = 0; i < tlb->sets * tlb->ways; i++) tlb->tag[i] = -1;
+    return 0;
+}
+
+static void tlb_free(Tlb *tlb) {
+    free(tlb->tag);
+    free(tlb->stamp);
+}
+
+// Returns 1 on a hit; on a miss the unit is filled in
+static int tlb_lookup(Tlb *tlb, int unit) {
+    int base = (int)((unsigned)unit % tlb->sets) * tlb->ways;
+    int *tag = tlb->tag + base;
+    long long *stamp = tlb->stamp + base;
+    int lru = 0;
+
+    tlb->clock++;
+    for (int w = 0; w < tlb->ways; w++) {
+        if (tag[w] == unit) {
+            stamp[w] = tlb->clock;
+            return 1;
+        }
+        if (stamp[w] < stamp[lru]) lru = w;
+    }
+    tag[lru] = unit;
+    stamp[lru] = tlb->clock;
+    return 0;
+}
+
+// The unit lost its frame, so its translation goes too
+static void tlb_invalidate(Tlb *tlb, int unit) {
+    int base = (int)((unsigned)unit % tlb->sets) * tlb->ways;
+    for (int w = base; w < base + tlb->ways; w++) {
+        if (tlb->tag[w] == unit) {
+            tlb->tag[w] = -1;
+            tlb->stamp[w] = 0;
+        }
+    }
+}
+
+int page_xlat_run(const int ref[], int n, const PagePolicy *pol, int frames, const PageXlatParams *prm,
+                  PageXlatResult *res) {
+    int shift = prm->huge ? PAGE_LEVEL_BITS : 0;
+    int walk = prm->levels - (prm->huge ? 1 : 0);
+    int *unit = malloc((n ? n : 1) * sizeof *unit);
+    PageSim s;
+    Tlb tlb;
+
+    memset(res, 0, sizeof *res);
+    if (!unit) return -1;
+    // A page table of L levels maps L * 9 bits of page number
+    for (int i = 0; i < n; i++) {
+        if (prm->levels * PAGE_LEVEL_BITS < 31 && ref[i] >> (prm->levels * PAGE_LEVEL_BITS) != 0) {
+            fprintf(stderr, "Page %d needs more than %d page-table levels.\n", ref[i], prm->levels);
+            free(unit);
+            return -1;
+        }
+        unit[i] = ref[i] >> shift;
+    }
+    // With huge pages every frame holds 512 base pages
+    res->frames = frames >> shift > 0 ? frames >> shift : 1;
+    if (tlb_init(&tlb, prm->tlb_entries, prm->tlb_ways) != 0) {
+        free(unit);
+        return -1;
+    }
+    if (page_sim_init(&s, pol, res->frames, unit, n) != 0) {
+        tlb_free(&tlb);
+        free(unit);
+        return -1;
+    }
+
+    double t0 = now_seconds();
+    for (int i = 0; i < n; i++) {
+        if (tlb_lookup(&tlb, unit[i])) {
+            res->tlb_hits++;
+        } else {
+            res->walks++;
+            res->walk_reads += walk;
+        }
+        // The replacement policy sees every reference, hit or miss
+        if (page_access(&s, unit[i]) && s.evicted >= 0) tlb_invalidate(&tlb, s.evicted);
+    }
+    res->elapsed = now_seconds() - t0;
+
+    res->refs = n;
+    res->faults = s.faults;
+    // Every reference pays the TLB lookup and the access itself; misses add
+    // one memory read per page-table level walked, faults the fault service
+    res->eat_ns = n > 0 ? prm->tlb_ns + prm->mem_ns +
+                          (res->walk_reads * prm->mem_ns + res->faults * prm->fault_ns) / n : 0;
+
+    page_sim_free(&s);
+    tlb_free(&tlb);
+    free(unit);
+    return 0;
+}
+
+// "4 KiB", "2 MiB", ...
+static void format_size(char *buf, size_t len, unsigned long long bytes) {
+    const char *unit[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+    int u = 0;
+    while (bytes >= 1024 && bytes % 1024 == 0 && u < 4) {
+        bytes /= 1024;
+        u++;
+    }
+    snprintf(buf, len, "%llu %s", bytes, unit[u]);
+}
+
+void page_xlat_header(const PageXlatParams *prm, int n) {
+    printf("\n--- Address Translation (TLB: %d entries, ", prm->tlb_entries);
+    if (prm->tlb_ways > 0 && prm->tlb_ways < prm->tlb_entries) printf("%d-way", prm->tlb_ways);
+    else printf("fully associative");
+    printf("; %d-level page table; References: %d) ---\n", prm->levels, n);
+    printf("Costs: TLB %.1fns, memory access %.1fns, page fault %.1fns\n", prm->tlb_ns, prm->mem_ns, prm->fault_ns);
+    printf("+---------------+-----------+---------+----------+-------------+-------------+-------------+-------------+\n");
+    printf("| Policy        | Page Size | Frames  | TLB Hits | TLB Misses  | Walk Reads  | Page Faults | EAT (ns)    |\n");
+    printf("+---------------+-----------+---------+----------+-------------+-------------+-------------+-------------+\n");
+}
+
+void page_xlat_row(const PagePolicy *pol, int page_shift, const PageXlatParams *prm, const PageXlatResult *res) {
+    char size[32];
+    format_size(size, sizeof size, 1ULL << (page_shift + (prm->huge ? PAGE_LEVEL_BITS : 0)));
+    printf("| %-13s | %9s | %7d | %7.2f%% | %11lld | %11lld | %11lld | %11.1f |\n", pol->title, size, res->frames,
+           res->refs > 0 ? (float)res->tlb_hits * 100 / res->refs : 0, res->walks, res->walk_reads, res->faults,
+           res->eat_ns);
+}
+
+void page_xlat_footer(void) {
+    printf("+---------------+-----------+---------+----------+-------------+-------------+-------------+-------------+\n");
+}
+
+// ===================================================================
+// Batch (trace file) mode
+// ===================================================================
+
+static void batch_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s -f TRACE -n FRAMES[,...] [-j THREADS] [-p POLICIES] [-m] [-q | -S EVERY] [-b | -l] [-r RUNS]\n"
+            "       %s -V ALLOC -f TRACE [-f TRACE ...] -n FRAMES [-Q QUANTUM] [-w WINDOW] [-i INTERVAL]\n"
+            "       %s -T ENTRIES -f TRACE -n FRAMES [-p POLICIES] [-A WAYS] [-L LEVELS] [-c TLB,MEM,FAULT]\n"
+            "  -f TRACE     page numbers as text (white space separated, '#' comments)\n"
+            "               or a binary trace written by pagetrace\n"
+            "  -n FRAMES    number of frames; a list such as 3,4,8 runs every policy at every\n"
+            "               frame count in parallel and prints one matrix\n"
+            "  -j THREADS   threads for the matrix (default: one per CPU; also forces the matrix)\n"
+            "  -p POLICIES  comma-separated list of policies or \"all\" (default: this program's)\n"
+            "               fifo, lru, opt, clock, sc, lfu, arc, 2q\n"
+            "  -m           also print the LRU miss-ratio curve for every frame count\n"
+            "  -q           quiet: totals and simulation speed only, no frame table\n"
+            "  -S EVERY     print the frames after every EVERY-th reference only\n"
+            "  -b           benchmark: time each policy (default: all) on the trace held in memory\n"
+            "  -r RUNS      benchmark: runs per policy, the fastest is reported (default 3)\n"
+            "  -l           benchmark the frame lookups (hash table, scalar/SSE2/AVX2 scans) at\n"
+            "               each -n frame count (default 4,16,64)\n"
+            "  -V ALLOC     several processes, one per -f TRACE, share the frames: global, local,\n"
+            "               ws (working set), pff (page-fault frequency) or all\n"
+            "  -Q QUANTUM   references a process makes per turn (default 100)\n"
+            "  -w WINDOW    working-set window / PFF threshold, in a process's references (default 1000)\n"
+            "  -i INTERVAL  references between thrashing checks (default 10000)\n"
+            "  -T ENTRIES   translate through a TLB of ENTRIES entries and a radix page table,\n"
+            "               with base pages and with huge pages (512 base pages)\n"
+            "  -A WAYS      TLB associativity (default 4; 0 = fully associative)\n"
+            "  -L LEVELS    page-table levels, 2 to 4 (default 4)\n"
+            "  -c T,M,F     costs in ns of a TLB lookup, a memory access and a page fault\n"
+            "               (default 1,100,100000)\n",
+            prog, prog, prog);
+}
+
+// Parse a list of positive numbers such as "3,4,8"; returns the count or -1
+static int parse_int_list(const char *list, int v[], int max) {
+    int count = 0;
+    while (*list) {
+        char *end;
+        long x = strtol(list, &end, 10);
+        if (end == list || x <= 0 || x > INT_MAX || count == max) return -1;
+        v[count++] = (int)x;
+        list = end;
+        if (*list == ',') list++;
+        else if (*list) return -1;
+    }
+    return count > 0 ? count : -1;
+}
+
+// Parse "fifo,lru" / "all" into 'pols'; returns the count or -1 on error
+static int parse_policy_list(const char *list, const PagePolicy *pols[], int max) {
+    if (strcmp(list, "all") == 0) {
+        for (int i = 0; i < PAGE_NUM_POLICIES && i < max; i++) pols[i] = PAGE_POLICIES[i];
+        return PAGE_NUM_POLICIES < max ? PAGE_NUM_POLICIES : max;
+    }
+
+    int count = 0;
+    char name[32];
+    while (*list) {
+        size_t len = strcspn(list, ",");
+        if (len == 0 || len >= sizeof name || count == max) return -1;
+        memcpy(name, list, len);
+        name[len] = '\0';
+        if (!(pols[count++] = page_policy_by_name(name))) {
+            fprintf(stderr, "Unknown policy \"%s\"\n", name);
+            return -1;
+        }
+        list += len;
+        if (*list == ',') list++;
+    }
+    return count;
+}
+
+// Fastest of 'runs' silent runs of one policy, in seconds (-1 on failure);
+// 'lookup' overrides the frame lookup unless it is -1
+static double time_policy(const PagePolicy *pol, const int ref[], int n, int frames, int lookup, int runs,
+                          long long *faults) {
+    double best = -1;
+    for (int r = 0; r < runs; r++) {
+        PageSim s;
+        RefSource src = { ref, n, 0, NULL };
+        // Setup (OPT's next-use index included) is part of the cost
+        double t0 = now_seconds();
+        if (page_sim_init(&s, pol, frames, ref, n) != 0) {
+            printf("Memory allocation failed.\n");
+            return -1;
+        }
+        if (lookup >= 0) s.lookup = lookup;
+        run_quiet(&s, &src);
+        double elapsed = now_seconds() - t0;
+        *faults = s.faults;
+        page_sim_free(&s);
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+// Time each policy over the same in-memory string, nothing printed while
+// running; the fastest of 'runs' runs is reported
+static int benchmark(const PagePolicy *pols[], int npols, const int ref[], int n, int frames, int runs) {
+    printf("\n--- Benchmark (Frames: %d, References: %d, best of %d runs) ---\n", frames, n, runs);
+    printf("+---------------+-------------+------------+--------------+----------+\n");
+    printf("| Policy        | Page Faults | Time (s)   | Refs/s       | ns/Ref   |\n");
+    printf("+---------------+-------------+------------+--------------+----------+\n");
+    for (int i = 0; i < npols; i++) {
+        long long faults = 0;
+        double best = time_policy(pols[i], ref, n, frames, -1, runs, &faults);
+        if (best < 0) return -1;
+        printf("| %-13s | %11lld | %10.4f | %12.0f | %8.2f |\n", pols[i]->title, faults, best,
+               best > 0 ? n / best : 0, n > 0 ? best * 1e9 / n : 0);
+        fflush(stdout);
+    }
+    printf("+---------------+-------------+------------+--------------+----------+\n");
+    return 0;
+}
+
+// ns per reference with every frame lookup this CPU supports, and the
+// speedup of the fastest scan over the hash table
+static int lookup_benchmark(const PagePolicy *pols[], int npols, const int ref[], int n, const int frames[],
+                            int nframes, int runs) {
+    printf("\n--- Frame Lookup Benchmark (References: %d, best of %d runs, ns per reference) ---\n", n, runs);
+    printf("+--------+---------------+----------+----------+----------+----------+---------+\n");
+    printf("| Frames | Policy        | hash     | scalar   | SSE2     | AVX2     | Speedup |\n");
+    printf("+--------+---------------+----------+----------+----------+----------+---------+\n");
+    for (int i = 0; i < nframes; i++) {
+        for (int j = 0; j < npols; j++) {
+            double hash = 0, fastest = 0;
+            printf("| %6d | %-13s |", frames[i], pols[j]->title);
+            for (int l = PAGE_LOOKUP_HASH; l <= PAGE_LOOKUP_AVX2; l++) {
+                long long faults;
+                if (!page_lookup_supported(l) || (l != PAGE_LOOKUP_HASH && frames[i] > PAGE_SCAN_MAX_FRAMES)) {
+                    printf(" %8s |", "-");
+                    continue;
+                }
+                double t = time_policy(pols[j], ref, n, frames[i], l, runs, &faults);
+                if (t < 0) return -1;
+                double ns = n > 0 ? t * 1e9 / n : 0;
+                printf(" %8.2f |", ns);
+                if (l == PAGE_LOOKUP_HASH) hash = ns;
+                else if (fastest == 0 || ns < fastest) fastest = ns;
+            }
+            if (fastest > 0) printf(" %6.2fx |\n", hash / fastest);
+            else printf(" %7s |\n", "-");
+            fflush(stdout);
+        }
+    }
+    printf("+--------+---------------+----------+----------+----------+----------+---------+\n");
+    return 0;
+}
+
+// Parse "1,100,100000" into the three costs; returns 0 on success
+static int parse_costs(const char *list, double v[3]) {
+    for (int i = 0; i < 3; i++) {
+        char *end;
+        v[i] = strtod(list, &end);
+        if (end == list || v[i] < 0 || *end != (i < 2 ? ',' : '\0')) return -1;
+        list = end + 1;
+    }
+    return 0;
+}
+
+// Every policy behind the TLB, with base pages and then huge pages
+static int batch_xlat(const char *path, const PagePolicy *const pols[], int npols, int frames, PageXlatParams *prm) {
+    PageTrace t;
+    int *ref, n, rc = 0;
+
+    // Only the header's page size is needed from this first look
+    if (page_trace_open(&t, path) != 0) return 1;
+    int page_shift = t.binary && t.page_shift ? (int)t.page_shift : 12;
+    page_trace_close(&t);
+    if (page_trace_load(path, &ref, &n) != 0) return 1;
+
+    // Everything runs before the table starts, so an error doesn't cut it short
+    PageXlatResult res[2 * PAGE_MAX_BATCH_POLICIES];
+    for (int i = 0; i < 2 * npols && rc == 0; i++) {
+        prm->huge = i % 2;
+        if (page_xlat_run(ref, n, pols[i / 2], frames, prm, &res[i]) != 0) rc = 1;
+    }
+    if (rc == 0) {
+        page_xlat_header(prm, n);
+        for (int i = 0; i < 2 * npols; i++) {
+            prm->huge = i % 2;
+            page_xlat_row(pols[i / 2], page_shift, prm, &res[i]);
+        }
+        page_xlat_footer();
+    }
+    free(ref);
+    return rc;
+}
+
+// Run the processes under each allocation policy in turn
+static int batch_vm(const char *const paths[], int nprocs, PageVmParams *prm, int all) {
+    PageTrace traces[PAGE_MAX_VM_PROCS];
+    int opened = 0, rc = 0;
+
+    if (prm->alloc == PAGE_VM_LOCAL && prm->frames < nprocs) {
+        fprintf(stderr, "Local allocation needs at least one frame per process.\n");
+        return 1;
+    }
+    for (; opened < nprocs; opened++) {
+        if (page_trace_open(&traces[opened], paths[opened]) != 0) {
+            rc = 1;
+            break;
+        }
+    }
+    for (int a = all ? 0 : prm->alloc; rc == 0 && a <= (all ? PAGE_VM_PFF : prm->alloc); a++) {
+        PageVmResult res;
+        if (a == PAGE_VM_LOCAL && prm->frames < nprocs) {
+            printf("\n(Local allocation skipped: fewer frames than processes)\n");
+            continue;
+        }
+        prm->alloc = a;
+        for (int i = 0; i < nprocs; i++) page_trace_rewind(&traces[i]);
+        if (page_vm_run(traces, nprocs, prm, &res) != 0) {
+            fprintf(stderr, "Memory allocation failed or corrupt trace.\n");
+            rc = 1;
+            break;
+        }
+        page_vm_print(prm, &res);
+        page_vm_result_free(&res);
+    }
+    for (int i = 0; i < opened; i++) page_trace_close(&traces[i]);
+    return rc;
+}
+
+int page_batch_main(int argc, char *argv[], const PagePolicy *const defaults[], int ndefaults) {
+    const char *trace_path = NULL;
+    const char *vm_paths[PAGE_MAX_VM_PROCS];
+    int nvm_paths = 0, vm = 0, vm_all = 0;
+    PageVmParams vmp = { 0, PAGE_VM_GLOBAL, 100, 1000, 10000 };
+    PageXlatParams xp = { 0, 4, 4, 0, 1, 100, 100000 };
+    const PagePolicy *pols[PAGE_MAX_BATCH_POLICIES];
+    int npols = 0, curve = 0, bench = 0, lookup_bench = 0, runs = 3, pols_given = 0;
+    int frame_list[PAGE_MAX_SWEEP_FRAMES];
+    int nframes = 0, frames = 0;
+    int threads = 0; // 0 = a single frame count runs in the classic format
+    SimOutput out = { 1, 1 };
+    int opt;
+
+    for (int i = 0; i < ndefaults && i < PAGE_MAX_BATCH_POLICIES; i++) pols[npols++] = defaults[i];
+
+    while ((opt = getopt(argc, argv, "f:n:j:p:mqS:blr:V:Q:w:i:T:A:L:c:h")) != -1) {
+        switch (opt) {
+            case 'f':
+                trace_path = optarg;
+                if (nvm_paths == PAGE_MAX_VM_PROCS) {
+                    fprintf(stderr, "At most %d traces.\n", PAGE_MAX_VM_PROCS);
+                    return 1;
+                }
+                vm_paths[nvm_paths++] = optarg;
+                break;
+            case 'V':
+                vm = 1;
+                vm_all = strcmp(optarg, "all") == 0;
+                if (!vm_all && (vmp.alloc = page_vm_alloc_by_name(optarg)) < 0) {
+                    fprintf(stderr, "Unknown allocation policy \"%s\"\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'T':
+                xp.tlb_entries = atoi(optarg);
+                if (xp.tlb_entries <= 0) {
+                    fprintf(stderr, "Invalid value \"%s\" for -T\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'A':
+                xp.tlb_ways = atoi(optarg);
+                if (xp.tlb_ways < 0) {
+                    fprintf(stderr, "Invalid value \"%s\" for -A\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'L':
+                xp.levels = atoi(optarg);
+                if (xp.levels < 2 || xp.levels > 4) {
+                    fprintf(stderr, "Page tables have 2 to 4 levels.\n");
+                    return 1;
+                }
+                break;
+            case 'c': {
+                double c[3];
+                if (parse_costs(optarg, c) != 0) {
+                    fprintf(stderr, "Costs must be three non-negative numbers, e.g. 1,100,100000.\n");
+                    return 1;
+                }
+                xp.tlb_ns = c[0];
+                xp.mem_ns = c[1];
+                xp.fault_ns = c[2];
+                break;
+            }
+            case 'Q':
+            case 'w':
+            case 'i': {
+                long long v = atoll(optarg);
+                if (v <= 0 || v > INT_MAX) {
+                    fprintf(stderr, "Invalid value \"%s\" for -%c\n", optarg, opt);
+                    return 1;
+                }
+                if (opt == 'Q') vmp.quantum = (int)v;
+                else if (opt == 'w') vmp.window = (int)v;
+                else vmp.interval = v;
+                break;
+            }
+            case 'm': curve = 1; break;
+            case 'q': out.sample = 0; break;
+            case 'b': bench = 1; break;
+            case 'l': lookup_bench = 1; break;
+            case 'S':
+                out.sample = atoll(optarg);
+                if (out.sample <= 0) {
+                    fprintf(stderr, "Invalid value \"%s\" for -S\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'r':
+                runs = atoi(optarg);
+                if (runs <= 0) {
+                    fprintf(stderr, "Invalid value \"%s\" for -r\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'n':
+                nframes = parse_int_list(optarg, frame_list, PAGE_MAX_SWEEP_FRAMES);
+                for (int i = 0; i < nframes; i++) {
+                    if (frame_list[i] > PAGE_MAX_FRAMES) nframes = -1;
+                }
+                if (nframes <= 0) {
+                    fprintf(stderr, "Frame counts must be 1-%d numbers between 1 and %d, e.g. 3 or 3,4,8.\n",
+                            PAGE_MAX_SWEEP_FRAMES, PAGE_MAX_FRAMES);
+                    return 1;
+                }
+                frames = frame_list[0];
+                break;
+            case 'j':
+                threads = atoi(optarg);
+                if (threads <= 0 || threads > PAGE_MAX_SWEEP_THREADS) {
+                    fprintf(stderr, "Thread count must be between 1 and %d.\n", PAGE_MAX_SWEEP_THREADS);
+                    return 1;
+                }
+                break;
+            case 'p':
+                npols = parse_policy_list(optarg, pols, PAGE_MAX_BATCH_POLICIES);
+                pols_given = 1;
+                if (npols <= 0) {
+                    batch_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default:
+                batch_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (lookup_bench && nframes == 0) {
+        static const int small[] = { 4, 16, 64 };
+        nframes = 3;
+        memcpy(frame_list, small, sizeof small);
+        frames = frame_list[0];
+    }
+    if (!trace_path || frames == 0 || optind != argc || (nvm_paths > 1 && !vm) || (vm && nframes > 1)) {
+        batch_usage(argv[0]);
+        return 1;
+    }
+
+    if (xp.tlb_entries > 0) {
+        int rc;
+        if (nframes > 1 || vm) {
+            batch_usage(argv[0]);
+            return 1;
+        }
+        if (xp.tlb_ways > 0 && xp.tlb_entries % xp.tlb_ways != 0) {
+            fprintf(stderr, "TLB entries must be a multiple of the associativity.\n");
+            return 1;
+        }
+        setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+        rc = batch_xlat(trace_path, pols, npols, frames, &xp);
+        fflush(stdout);
+        return rc;
+    }
+
+    if (vm) {
+        int rc;
+        vmp.frames = frames;
+        setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+        rc = batch_vm(vm_paths, nvm_paths, &vmp, vm_all);
+        fflush(stdout);
+        return rc;
+    }
+
+    if (lookup_bench) {
+        int *ref, n, rc;
+        if (page_trace_load(trace_path, &ref, &n) != 0) return 1;
+        rc = lookup_benchmark(pols, npols, ref, n, frame_list, nframes, runs) == 0 ? 0 : 1;
+        free(ref);
+        return rc;
+    }
+    if (bench && nframes > 1) {
+        fprintf(stderr, "The benchmark takes a single frame count.\n");
+        return 1;
+    }
+    if (bench) {
+        // Decoding is kept out of the timings, so the string is loaded first
+        int *ref, n, rc;
+        if (!pols_given) npols = parse_policy_list("all", pols, PAGE_MAX_BATCH_POLICIES);
+        if (page_trace_load(trace_path, &ref, &n) != 0) return 1;
+        rc = benchmark(pols, npols, ref, n, frames, runs) == 0 ? 0 : 1;
+        free(ref);
+        return rc;
+    }
+
+    if (nframes > 1 || threads > 0) {
+        // Every cell reads the same in-memory string
+        int *ref, n, rc;
+        if (page_trace_load(trace_path, &ref, &n) != 0) return 1;
+        setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+        rc = batch_matrix(pols, npols, frame_list, nframes, ref, n, threads);
+        if (rc == 0 && curve) print_miss_ratio_curve(ref, n);
+        fflush(stdout);
+        free(ref);
+        return rc;
+    }
+
+    PageTrace trace;
+    if (page_trace_open(&trace, trace_path) != 0) return 1;
+
+    // OPT looks ahead and the curve needs every reference; everything else
+    // streams straight from the mapped file
+    int need_array = curve;
+    for (int i = 0; i < npols; i++) need_array |= pols[i] == &PAGE_OPT;
+    int *ref = NULL;
+    int n = 0;
+    if (need_array) {
+        page_trace_close(&trace);
+        if (page_trace_load(trace_path, &ref, &n) != 0) return 1;
+    }
+    RefSource src = { ref, n, 0, need_array ? NULL : &trace };
+
+    // Results go out in large chunks rather than a write per reference
+    setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+
+    long long faults[PAGE_MAX_BATCH_POLICIES];
+    long long total = 0;
+    int rc = 0;
+    for (int i = 0; i < npols; i++) {
+        source_rewind(&src);
+        faults[i] = simulate(pols[i], &src, frames, &out, &total);
+        if (faults[i] < 0) {
+            rc = 1;
+            break;
+        }
+        if (!need_array && trace.error) {
+            fflush(stdout);
+            fprintf(stderr, "%s: truncated or corrupt trace\n", trace_path);
+            rc = 1;
+            break;
+        }
+    }
+    if (rc == 0 && npols > 1) {
+        comparison_header(frames, total);
+        for (int i = 0; i < npols; i++) comparison_row(pols[i], faults[i], total);
+        comparison_footer();
+    }
+    if (rc == 0 && curve) print_miss_ratio_curve(ref, n);
+
+    fflush(stdout);
+    free(ref);
+    if (!need_array) page_trace_close(&trace);
+    return rc;
+}
+
+// ===================================================================
+// OPT preprocessing
+// ===================================================================
+
+int *page_next_use(const int ref[], int n) {
+    int *next = malloc((n ? n : 1) * sizeof *next);
+    PageMap last; // Page -> its earliest reference seen so far in the sweep
+    if (!next || pagemap_init(&last, n) != 0) {
+        free(next);
+        return NULL;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        int j = pagemap_get(&last, ref[i]);
+        next[i] = j >= 0 ? j : n;
+        pagemap_put(&last, ref[i], i);
+    }
+    pagemap_free(&last);
+    return next;
+}
+
+// ===================================================================
+// Stack distances
+// ===================================================================
+
+// Fenwick tree over positions 1..n
+static void fenwick_add(int *tree, int n, int i, int v) {
+    for (; i <= n; i += i & -i) tree[i] += v;
+}
+
+static int fenwick_sum(const int *tree, int i) {
+    int s = 0;
+    for (; i > 0; i -= i & -i) s += tree[i];
+    return s;
+}
+
+long long *page_stack_distances(const int ref[], int n, int *distinct) {
+    int *tree = calloc(n + 1, sizeof *tree);
+    long long *hist = calloc(n + 1, sizeof *hist); // Distances never exceed n
+    PageMap last; // Page -> time (1-based) of its latest reference
+    int pages = 0;
+
+    if (!tree || !hist || pagemap_init(&last, n) != 0) {
+        free(tree);
+        free(hist);
+        return NULL;
+    }
+    for (int i = 1; i <= n; i++) {
+        int prev = pagemap_get(&last, ref[i - 1]);
+        if (prev < 0) {
+            hist[0]++;
+            pages++;
+        } else {
+            // Pages whose latest reference falls after prev, plus this one
+            hist[fenwick_sum(tree, i - 1) - fenwick_sum(tree, prev) + 1]++;
+            fenwick_add(tree, n, prev, -1);
+        }
+        fenwick_add(tree, n, i, 1);
+        pagemap_put(&last, ref[i - 1], i);
+    }
+    pagemap_free(&last);
+    free(tree);
+
+    *distinct = pages;
+    long long *h = realloc(hist, (pages + 1) * sizeof *hist);
+    return h ? h : hist;
+}
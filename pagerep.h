@@ -0,0 +1,294 @@
+// pagerep.h — page replacement engines shared by 6.1.c and 6.2.c
+//
+// One reference loop (page_access) drives every policy through a small
+// vtable, the same way scheduler.h drives the CPU schedulers. Pages live in
+// numbered frames (frame[i], -1 = empty) so the programs can print the frame
+// table exactly as before, while hits are found through a hash table and
+// every policy picks its victim in O(1) or O(log frames).
+#ifndef PAGEREP_H
+#define PAGEREP_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Page -> frame hash table (open addressing, linear probing) ---
+typedef struct {
+    int *page;     // Key per slot (PAGEMAP_EMPTY if unused)
+    int *frame;    // Value per slot
+    unsigned mask; // Slots - 1 (a power of two)
+    int shift;     // 32 - log2(slots), for the multiplicative hash
+} PageMap;
+
+// Returns 0 on success, -1 on allocation failure; holds up to 'capacity' pages
+int  pagemap_init(PageMap *m, int capacity);
+void pagemap_free(PageMap *m);
+int  pagemap_get(const PageMap *m, int page); // Frame holding 'page', or -1
+void pagemap_put(PageMap *m, int page, int frame);
+void pagemap_del(PageMap *m, int page);
+
+typedef struct PagePolicy PagePolicy;
+
+// --- How page_access() finds the frame holding a page ---
+enum {
+    PAGE_LOOKUP_HASH,   // The page -> frame hash table (any frame count)
+    PAGE_LOOKUP_SCALAR, // A scan of the frame array, one frame at a time
+    PAGE_LOOKUP_SSE2,   // The same scan, 4 frames per compare
+    PAGE_LOOKUP_AVX2    // The same scan, 8 frames per compare
+};
+
+// Scans can be used up to this many frames, and are picked by default up to
+// PAGE_SCAN_AUTO_FRAMES: past about 8 frames the hash table was faster on
+// some machines (FIFO and LRU at 16 and 64 frames; measure with -l)
+#define PAGE_SCAN_MAX_FRAMES 64
+#define PAGE_SCAN_AUTO_FRAMES 8
+
+// --- Mutable state of one simulation ---
+typedef struct {
+    const PagePolicy *pol;
+    int frames;       // Number of frames
+    int used;         // Frames filled so far (they fill in order 0, 1, ...)
+    int *frame;       // Page held by each frame, -1 if empty
+    PageMap map;      // Resident page -> frame
+    const int *ref;   // The whole reference string, if known (OPT needs it)
+    int n;            // Its length
+    long long t;      // References made so far (index of the current one)
+    long long faults; // Page faults so far
+    int evicted;      // Page the last reference evicted, -1 if none
+    int lookup;       // PAGE_LOOKUP_* used to find resident pages
+    void *state;      // Policy-private bookkeeping
+} PageSim;
+
+// --- Policy interface ---
+// page_access() finds hits itself and fills empty frames in order; a policy
+// only tracks its own ordering and, once every frame is full, names the
+// frame to evict. s->t is the index of the reference being made.
+struct PagePolicy {
+    const char *name;  // Short name (used on command lines)
+    const char *title; // Name in tables ("FIFO", "LRU", ...)
+    int  (*init)(PageSim *s);             // Allocate 'state'; 0 on success
+    void (*destroy)(PageSim *s);
+    void (*on_hit)(PageSim *s, int f);    // The page in frame f was referenced
+    int  (*victim)(PageSim *s, int page); // All frames full: pick the frame to reuse for 'page'
+    void (*on_load)(PageSim *s, int f);   // frame[f] now holds the faulting page
+};
+
+extern const PagePolicy PAGE_FIFO;
+extern const PagePolicy PAGE_LRU;
+extern const PagePolicy PAGE_OPT;
+extern const PagePolicy PAGE_CLOCK;
+extern const PagePolicy PAGE_SECOND_CHANCE;
+extern const PagePolicy PAGE_LFU;
+extern const PagePolicy PAGE_ARC;
+extern const PagePolicy PAGE_2Q;
+
+// All built-in policies, in table order
+extern const PagePolicy *const PAGE_POLICIES[];
+extern const int PAGE_NUM_POLICIES;
+
+// 'ref' may be NULL for every policy except OPT; returns 0 on success, -1 on
+// allocation failure (or OPT without a reference string). Up to
+// PAGE_SCAN_AUTO_FRAMES the fastest scan this CPU supports is picked, the
+// hash table beyond; s->lookup may be changed to any other supported lookup
+// (scans only up to PAGE_SCAN_MAX_FRAMES) before the first reference.
+int  page_sim_init(PageSim *s, const PagePolicy *pol, int frames, const int ref[], int n);
+void page_sim_free(PageSim *s);
+// Reference 'page': returns 1 on a page fault, 0 on a hit
+int  page_access(PageSim *s, int page);
+
+const PagePolicy *page_policy_by_name(const char *name);
+
+// Whether this CPU can run a PAGE_LOOKUP_* method, and its name in tables
+int  page_lookup_supported(int lookup);
+const char *page_lookup_name(int lookup);
+
+// Run one policy over the string, printing the frames after every reference
+// and the totals (the classic 6.x table); returns 0 on success
+int  page_simulate(const PagePolicy *pol, const int ref[], int n, int frames);
+void print_frames(const int frame_array[], int frames, int page_fault);
+
+// Run every built-in policy over the same string and print one summary table
+void page_compare(const int ref[], int n, int frames);
+
+// LRU faults for every frame count from 1 up to the number of distinct pages
+void print_miss_ratio_curve(const int ref_string[], int pages);
+
+// Returns a malloc'd next-use array for ref[0..n-1] (next[i] is the index of
+// the next reference to ref[i]'s page, n if none), or NULL on failure
+int *page_next_use(const int ref[], int n);
+
+// --- Mattson stack distances: LRU faults for every frame count at once ---
+// A reference's stack distance is the number of distinct pages used since the
+// previous reference to the same page, counting itself; LRU with F frames hits
+// exactly the references at distance <= F. A Fenwick tree over reference times,
+// holding a 1 at each page's latest reference, counts those pages in
+// O(log n), so the whole miss-ratio curve costs one O(n log n) pass.
+//
+// Returns a malloc'd histogram h[0..*distinct]: h[d] references at stack
+// distance d, and h[0] first references (cold misses, whatever the frame
+// count). Returns NULL on allocation failure.
+long long *page_stack_distances(const int ref[], int n, int *distinct);
+
+// --- Reference trace files ---
+// Text traces are decimal page numbers separated by white space ('#' starts
+// a comment). Binary traces hold a 16-byte header followed by 'count' page
+// numbers, each stored as the zigzag LEB128 varint of its difference from the
+// previous page (the first from 0), so sequential and looping access costs
+// about a byte per reference. Both are read through a read-only mapping.
+#define PAGE_TRACE_MAGIC "PGRT"
+
+typedef struct {
+    char magic[4];       // PAGE_TRACE_MAGIC
+    uint32_t page_shift; // log2 of the page size the addresses were cut at (0 = unknown)
+    uint64_t count;      // Number of references
+} PageTraceHeader;
+
+typedef struct {
+    const unsigned char *map; // The mapped file
+    const unsigned char *p;   // Next byte to decode
+    const unsigned char *end;
+    size_t size;
+    int binary;
+    uint64_t count;      // References in the file
+    uint64_t left;       // Binary: references not yet decoded
+    uint32_t page_shift;
+    int64_t prev;        // Binary: the last page decoded
+    int error;           // Set when a malformed reference is met
+} PageTrace;
+
+typedef struct {
+    FILE *f;
+    int64_t prev;
+    uint64_t count;
+    int page_shift;
+} PageTraceWriter;
+
+// Open and map a text or binary trace (detected from the magic); errors are
+// reported on stderr and -1 is returned
+int  page_trace_open(PageTrace *t, const char *path);
+// Next page into *page: returns 1, 0 at the end, -1 on a malformed trace
+int  page_trace_next(PageTrace *t, int *page);
+void page_trace_rewind(PageTrace *t);
+void page_trace_close(PageTrace *t);
+// Read a whole trace into a malloc'd array; returns 0 on success
+int  page_trace_load(const char *path, int **ref, int *n);
+
+// Write a binary trace; close returns 0 once everything reached the file
+int  page_writer_open(PageTraceWriter *w, const char *path, int page_shift);
+void page_writer_put(PageTraceWriter *w, int page);
+int  page_writer_close(PageTraceWriter *w);
+
+// --- One cell of a policy x frame count sweep ---
+typedef struct {
+    const PagePolicy *pol; // In: policy to run
+    int frames;            // In: frame count
+    long long faults;      // Out: filled when rc == 0
+    double elapsed;        // Out: wall-clock seconds the cell took
+    int rc;                // Out: result of page_sim_init()
+} PageSweepJob;
+
+#define PAGE_MAX_SWEEP_THREADS 256
+#define PAGE_MAX_SWEEP_FRAMES 64
+
+// Run every job over ref[0..n-1] on up to 'threads' threads sharing the one
+// read-only string; returns 0 when all of them succeeded
+int  page_sweep(const int ref[], int n, PageSweepJob *jobs, int njobs, int threads);
+
+// --- Several processes sharing one pool of frames ---
+// Each process reads its own trace; they take turns of 'quantum' references
+// and replace pages LRU within the frames they may use. The working set of a
+// process is the set of distinct pages in its last 'window' references.
+enum {
+    PAGE_VM_GLOBAL, // Any frame may be taken, from any process
+    PAGE_VM_LOCAL,  // The frames are split equally; a process replaces only its own
+    PAGE_VM_WS,     // A page stays resident exactly while it is in its process's working set
+    PAGE_VM_PFF     // Page-fault frequency: a fault more than 'window' references after the
+                    // previous one first drops the pages not used since then
+};
+
+typedef struct {
+    int frames;
+    int alloc;          // PAGE_VM_*
+    int quantum;        // References a process makes per turn
+    int window;         // Working-set window, in the process's own references
+    long long interval; // References between thrashing checks
+} PageVmParams;
+
+typedef struct {
+    long long refs;
+    long long faults;
+    long long rss_sum; // Frames held after each reference, summed (for the mean)
+    int max_ws;        // Largest working set seen
+    int suspensions;   // Times it was swapped out (WS and PFF load control)
+} PageVmProcStats;
+
+typedef struct {
+    int nprocs;
+    PageVmProcStats *proc; // Per process
+    long long refs;
+    long long faults;
+    long long suspensions;
+    long long intervals;    // Thrashing checks made...
+    long long thrashing;    // ...and those where the running processes' working sets exceeded the frames
+    long long first_thrash; // References made at the first of those (-1 = none)
+    double peak_fault_rate; // Highest faults per reference over one interval
+    double elapsed;         // Wall-clock seconds the simulation took
+} PageVmResult;
+
+// Run process i on traces[i] until every trace ends. With WS and PFF, a fault
+// that finds no free frame swaps out the running process holding the most
+// frames; it resumes once its working set fits again. PAGE_VM_LOCAL needs at
+// least one frame per process. Returns 0 on success, -1 on allocation failure
+// or a corrupt trace; free the result with page_vm_result_free().
+int  page_vm_run(PageTrace traces[], int nprocs, const PageVmParams *prm, PageVmResult *res);
+void page_vm_result_free(PageVmResult *res);
+void page_vm_print(const PageVmParams *prm, const PageVmResult *res);
+int  page_vm_alloc_by_name(const char *name); // "global", "local", "ws", "pff"; -1 if unknown
+
+#define PAGE_MAX_VM_PROCS 64
+
+// --- Address translation in front of the replacement policy ---
+// Every reference is looked up in a set-associative LRU TLB; a miss walks a
+// radix page table of 'levels' levels of PAGE_LEVEL_BITS bits each (x86-64:
+// 4 levels of 9 bits over 4 KiB pages). Huge pages are one level up (512
+// base pages, 2 MiB over 4 KiB): the walk is a level shorter, one TLB entry
+// covers 512 times as much, and the frames are counted in huge pages.
+#define PAGE_LEVEL_BITS 9
+
+typedef struct {
+    int tlb_entries;
+    int tlb_ways;    // Entries per set (0 or tlb_entries = fully associative)
+    int levels;      // Page-table levels, 2 to 4
+    int huge;        // Translate huge pages instead of base pages
+    double tlb_ns;   // Cost of a TLB lookup
+    double mem_ns;   // Cost of one memory access (the data, or one page-table entry)
+    double fault_ns; // Cost of servicing a page fault
+} PageXlatParams;
+
+typedef struct {
+    long long refs;
+    long long tlb_hits;
+    long long walks;      // TLB misses, each a page-table walk
+    long long walk_reads; // Page-table entries read by those walks
+    long long faults;
+    int frames;           // Frames the replacement policy had (huge ones with 'huge')
+    double eat_ns;        // Effective access time per reference
+    double elapsed;       // Wall-clock seconds the simulation took
+} PageXlatResult;
+
+// Translate ref[0..n-1] (base page numbers) and run 'pol' over 'frames' base
+// frames behind the TLB; evicted pages are shot down from it. Returns 0 on
+// success, -1 on allocation failure or a page too large for the levels.
+int  page_xlat_run(const int ref[], int n, const PagePolicy *pol, int frames, const PageXlatParams *prm,
+                   PageXlatResult *res);
+void page_xlat_header(const PageXlatParams *prm, int n);
+void page_xlat_row(const PagePolicy *pol, int page_shift, const PageXlatParams *prm, const PageXlatResult *res);
+void page_xlat_footer(void);
+
+// Non-interactive entry point used when a program is started with arguments;
+// 'defaults' are the policies run when no -p option is given
+#define PAGE_MAX_BATCH_POLICIES 16
+#define PAGE_MAX_FRAMES (1 << 20)
+int  page_batch_main(int argc, char *argv[], const PagePolicy *const defaults[], int ndefaults);
+
+#endif
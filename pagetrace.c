@@ -0,0 +1,148 @@
+// Build: gcc pagetrace.c pagerep.c -pthread -o pagetrace
+//
+// Converts page reference traces for the page replacement simulators
+// (6.1.c, 6.2.c) into their compact binary format (-f in batch mode), and
+// dumps binary traces back to text. Input is either page numbers or the
+// memory accesses printed by "valgrind --tool=lackey --trace-mem=yes",
+// which are cut into pages. Input is read as a stream, so any size fits in
+// constant memory.
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h> // getopt
+#include <sys/stat.h>
+#include "pagerep.h"
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-l] [-s PAGESIZE] -o OUT [IN]\n"
+            "       %s -d TRACE\n"
+            "  -o OUT       write a binary trace to OUT (input is read from IN or stdin)\n"
+            "  -l           the input is a valgrind lackey log (\"I  0400d7d4,8\", \" L 1ffefffb80,4\")\n"
+            "  -s PAGESIZE  lackey: page size in bytes, a power of two (default 4096)\n"
+            "  -d TRACE     print a text or binary trace as page numbers, one per line\n",
+            prog, prog);
+}
+
+// One page number per token; '#' comments run to the end of the line
+static int convert_pages(FILE *in, PageTraceWriter *w) {
+    int c = getc(in);
+    while (c != EOF) {
+        if (c == '#') {
+            while (c != EOF && c != '\n') c = getc(in);
+        } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            c = getc(in);
+        } else if (c >= '0' && c <= '9') {
+            long long v = 0;
+            for (; c >= '0' && c <= '9'; c = getc(in)) {
+                v = v * 10 + (c - '0');
+                if (v > INT_MAX) {
+                    fprintf(stderr, "Page number too large after %llu references\n", (unsigned long long)w->count);
+                    return -1;
+                }
+            }
+            page_writer_put(w, (int)v);
+        } else {
+            fprintf(stderr, "Unexpected '%c' after %llu references\n", c, (unsigned long long)w->count);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Lackey lines: "I  addr,size" for instruction fetches and " L|S|M addr,size"
+// for data; anything else (the "==pid==" banner) is skipped. Page numbers keep
+// their low 31 bits, which only aliases pages more than 8 TiB apart at 4 KiB.
+static int convert_lackey(FILE *in, PageTraceWriter *w, int shift) {
+    char line[256];
+    while (fgets(line, sizeof line, in)) {
+        char kind;
+        unsigned long long addr;
+        unsigned size;
+        if (sscanf(line, " %c %llx,%u", &kind, &addr, &size) != 3) continue;
+        if (kind != 'I' && kind != 'L' && kind != 'S' && kind != 'M') continue;
+        if (size == 0) size = 1;
+        // An access straddling a page boundary touches both pages
+        unsigned long long first = addr >> shift, last = (addr + size - 1) >> shift;
+        for (unsigned long long pg = first; pg <= last; pg++) page_writer_put(w, (int)(pg & INT_MAX));
+    }
+    return 0;
+}
+
+static int dump(const char *path) {
+    PageTrace t;
+    int page, rc;
+    if (page_trace_open(&t, path) != 0) return 1;
+    setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+    if (t.binary && t.page_shift) printf("# page size %lu\n", 1UL << t.page_shift);
+    while ((rc = page_trace_next(&t, &page)) == 1) printf("%d\n", page);
+    page_trace_close(&t);
+    if (rc < 0) {
+        fprintf(stderr, "%s: truncated or corrupt trace\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *out_path = NULL, *dump_path = NULL;
+    int lackey = 0, shift = 12;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:ls:d:h")) != -1) {
+        switch (opt) {
+            case 'o': out_path = optarg; break;
+            case 'l': lackey = 1; break;
+            case 'd': dump_path = optarg; break;
+            case 's': {
+                unsigned long size = strtoul(optarg, NULL, 0);
+                if (size == 0 || (size & (size - 1)) || size > (1UL << 30)) {
+                    fprintf(stderr, "Page size must be a power of two up to 1 GiB.\n");
+                    return 1;
+                }
+                for (shift = 0; (1UL << shift) < size; shift++) {}
+                break;
+            }
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (dump_path) {
+        if (out_path || optind != argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        return dump(dump_path);
+    }
+    if (!out_path || argc - optind > 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *in = optind < argc ? fopen(argv[optind], "r") : stdin;
+    if (!in) {
+        perror(argv[optind]);
+        return 1;
+    }
+    PageTraceWriter w;
+    if (page_writer_open(&w, out_path, lackey ? shift : 0) != 0) return 1;
+
+    int rc = (lackey ? convert_lackey(in, &w, shift) : convert_pages(in, &w)) == 0 ? 0 : 1;
+    if (ferror(in)) {
+        perror(optind < argc ? argv[optind] : "stdin");
+        rc = 1;
+    }
+    struct stat st;
+    int regular = fstat(fileno(w.f), &st) == 0 && S_ISREG(st.st_mode);
+    if (page_writer_close(&w) != 0) {
+        perror(out_path);
+        rc = 1;
+    }
+    // The header holds the count so far, so a cut-short file would load as a
+    // (shorter) valid trace; leave devices and pipes alone
+    if (rc != 0 && regular) remove(out_path);
+    if (in != stdin) fclose(in);
+    if (rc == 0) fprintf(stderr, "%llu references written to %s\n", (unsigned long long)w.count, out_path);
+    return rc;
+}
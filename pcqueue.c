@@ -0,0 +1,929 @@
+// pcqueue.c — bounded producer/consumer queues and their benchmark
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>   // kill
+#include <limits.h>   // INT_MAX
+#include <sched.h>    // sched_yield
+#include <time.h>     // clock_gettime
+#include <unistd.h>   // getopt, syscall, ftruncate
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#include "pcqueue.h"
+
+// ===================================================================
+// Mutex + counting semaphores
+// ===================================================================
+
+int pc_sem_init(PcSemBuffer *b, int size) {
+    b->buf = malloc(size * sizeof *b->buf);
+    b->size = size;
+    b->in = b->out = 0;
+    if (!b->buf) return -1;
+    if (pthread_mutex_init(&b->lock, NULL) != 0) {
+        free(b->buf);
+        return -1;
+    }
+    if (sem_init(&b->empty_slots, 0, size) != 0 || sem_init(&b->full_slots, 0, 0) != 0) {
+        pthread_mutex_destroy(&b->lock);
+        free(b->buf);
+        return -1;
+    }
+    return 0;
+}
+
+void pc_sem_destroy(PcSemBuffer *b) {
+    sem_destroy(&b->empty_slots);
+    sem_destroy(&b->full_slots);
+    pthread_mutex_destroy(&b->lock);
+    free(b->buf);
+}
+
+void pc_sem_put(PcSemBuffer *b, PcItem item) {
+    sem_wait(&b->empty_slots);
+    pthread_mutex_lock(&b->lock);
+    b->buf[b->in] = item;
+    b->in = (b->in + 1) % b->size;
+    pthread_mutex_unlock(&b->lock);
+    sem_post(&b->full_slots);
+}
+
+PcItem pc_sem_get(PcSemBuffer *b) {
+    sem_wait(&b->full_slots);
+    pthread_mutex_lock(&b->lock);
+    PcItem item = b->buf[b->out];
+    b->out = (b->out + 1) % b->size;
+    pthread_mutex_unlock(&b->lock);
+    sem_post(&b->empty_slots);
+    return item;
+}
+
+// ===================================================================
+// Mutex + condition variables, in batches
+// ===================================================================
+
+int pc_cond_init(PcCondBuffer *b, int size) {
+    memset(b, 0, sizeof *b);
+    b->buf = malloc(size * sizeof *b->buf);
+    b->size = size;
+    if (!b->buf) return -1;
+    if (pthread_mutex_init(&b->lock, NULL) != 0) {
+        free(b->buf);
+        return -1;
+    }
+    if (pthread_cond_init(&b->not_full, NULL) != 0) {
+        pthread_mutex_destroy(&b->lock);
+        free(b->buf);
+        return -1;
+    }
+    if (pthread_cond_init(&b->not_empty, NULL) != 0) {
+        pthread_cond_destroy(&b->not_full);
+        pthread_mutex_destroy(&b->lock);
+        free(b->buf);
+        return -1;
+    }
+    return 0;
+}
+
+void pc_cond_destroy(PcCondBuffer *b) {
+    pthread_cond_destroy(&b->not_full);
+    pthread_cond_destroy(&b->not_empty);
+    pthread_mutex_destroy(&b->lock);
+    free(b->buf);
+}
+
+// Copy n items in at 'in' (out at 'out'), in at most two pieces around the end
+static void cond_copy_in(PcCondBuffer *b, const PcItem *items, int n) {
+    int first = n < b->size - b->in ? n : b->size - b->in;
+    memcpy(b->buf + b->in, items, first * sizeof *items);
+    memcpy(b->buf, items + first, (n - first) * sizeof *items);
+    b->in = (b->in + n) % b->size;
+}
+
+static void cond_copy_out(PcCondBuffer *b, PcItem *items, int n) {
+    int first = n < b->size - b->out ? n : b->size - b->out;
+    memcpy(items, b->buf + b->out, first * sizeof *items);
+    memcpy(items + first, b->buf, (n - first) * sizeof *items);
+    b->out = (b->out + n) % b->size;
+}
+
+// k items (slots) can feed at most k of the 'waiting' threads: wake only
+// those, so a batch does not send every waiter back to sleep on the mutex
+static void cond_wake(pthread_cond_t *cond, int waiting, int k) {
+    if (waiting > 1 && k >= waiting) {
+        pthread_cond_broadcast(cond);
+        return;
+    }
+    for (int i = 0; i < k && i < waiting; i++) pthread_cond_signal(cond);
+}
+
+void pc_produce_batch(PcCondBuffer *b, const PcItem *items, int n) {
+    while (n > 0) {
+        pthread_mutex_lock(&b->lock);
+        while (b->count == b->size) {
+            b->producers_waiting++;
+            pthread_cond_wait(&b->not_full, &b->lock);
+            b->producers_waiting--;
+        }
+        int k = b->size - b->count < n ? b->size - b->count : n;
+        cond_copy_in(b, items, k);
+        b->count += k;
+        int wake = b->consumers_waiting;
+        pthread_mutex_unlock(&b->lock);
+        cond_wake(&b->not_empty, wake, k);
+        items += k;
+        n -= k;
+    }
+}
+
+int pc_consume_batch(PcCondBuffer *b, PcItem *items, int max) {
+    pthread_mutex_lock(&b->lock);
+    while (b->count == 0) {
+        b->consumers_waiting++;
+        pthread_cond_wait(&b->not_empty, &b->lock);
+        b->consumers_waiting--;
+    }
+    int k = b->count < max ? b->count : max;
+    cond_copy_out(b, items, k);
+    b->count -= k;
+    int wake = b->producers_waiting;
+    pthread_mutex_unlock(&b->lock);
+    cond_wake(&b->not_full, wake, k);
+    return k;
+}
+
+// ===================================================================
+// Lock-free SPSC ring
+// ===================================================================
+
+// Busy-wait rounds before a waiting thread yields or sleeps
+#define PC_SPIN_LIMIT 64
+
+static void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Spin briefly, then give the CPU away (the other side may share it)
+static void backoff(unsigned *spins) {
+    if (++*spins < PC_SPIN_LIMIT) cpu_relax();
+    else sched_yield();
+}
+
+int pc_spsc_init(PcSpscRing *r, size_t capacity, size_t publish) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    memset(r, 0, sizeof *r);
+    atomic_init(&r->in, 0);
+    atomic_init(&r->out, 0);
+    r->mask = size - 1;
+    r->publish = publish > 0 ? publish : 1;
+    r->buf = aligned_alloc(PC_CACHE_LINE, (size * sizeof *r->buf + PC_CACHE_LINE - 1) & ~(size_t)(PC_CACHE_LINE - 1));
+    return r->buf ? 0 : -1;
+}
+
+void pc_spsc_destroy(PcSpscRing *r) {
+    free(r->buf);
+    r->buf = NULL;
+}
+
+void pc_spsc_put(PcSpscRing *r, PcItem item) {
+    size_t in = r->in_local;
+    if (in - r->out_cached > r->mask) {
+        // Looks full: let the consumer see what is already written, then wait
+        unsigned spins = 0;
+        atomic_store_explicit(&r->in, in, memory_order_release);
+        while (in - (r->out_cached = atomic_load_explicit(&r->out, memory_order_acquire)) > r->mask) {
+            backoff(&spins);
+        }
+    }
+    r->buf[in & r->mask] = item;
+    r->in_local = ++in;
+    if (in % r->publish == 0) atomic_store_explicit(&r->in, in, memory_order_release);
+}
+
+PcItem pc_spsc_get(PcSpscRing *r) {
+    size_t out = r->out_local;
+    if (out == r->in_cached) {
+        // Looks empty: hand back the slots already read, then wait
+        unsigned spins = 0;
+        atomic_store_explicit(&r->out, out, memory_order_release);
+        while (out == (r->in_cached = atomic_load_explicit(&r->in, memory_order_acquire))) backoff(&spins);
+    }
+    PcItem item = r->buf[out & r->mask];
+    r->out_local = ++out;
+    if (out % r->publish == 0) atomic_store_explicit(&r->out, out, memory_order_release);
+    return item;
+}
+
+void pc_spsc_flush(PcSpscRing *r) {
+    atomic_store_explicit(&r->in, r->in_local, memory_order_release);
+}
+
+// ===================================================================
+// Lock-free MPMC queue
+// ===================================================================
+
+// 'shared' futexes may be waited on by several processes (a shared mapping);
+// private ones are cheaper for the kernel to look up
+#ifdef __linux__
+static void futex_wait(atomic_uint *word, unsigned expected, int shared) {
+    syscall(SYS_futex, word, shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint *word, int count, int shared) {
+    syscall(SYS_futex, word, shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+#else
+// No futex: sleeping turns into yielding until the word changes
+static void futex_wait(atomic_uint *word, unsigned expected, int shared) {
+    (void)shared;
+    while (atomic_load(word) == expected) sched_yield();
+}
+
+static void futex_wake(atomic_uint *word, int count, int shared) {
+    (void)word;
+    (void)count;
+    (void)shared;
+}
+#endif
+
+int pc_mpmc_init(PcMpmcQueue *q, size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    memset(q, 0, sizeof *q);
+    atomic_init(&q->enqueue_pos, 0);
+    atomic_init(&q->dequeue_pos, 0);
+    atomic_init(&q->items.event, 0);
+    atomic_init(&q->items.state, 0);
+    atomic_init(&q->slots.event, 0);
+    atomic_init(&q->slots.state, 0);
+    q->mask = size - 1;
+    q->cells = aligned_alloc(PC_CACHE_LINE, (size * sizeof *q->cells + PC_CACHE_LINE - 1) & ~(size_t)(PC_CACHE_LINE - 1));
+    if (!q->cells) return -1;
+    for (size_t i = 0; i < size; i++) atomic_init(&q->cells[i].seq, i);
+    return 0;
+}
+
+void pc_mpmc_destroy(PcMpmcQueue *q) {
+    free(q->cells);
+    q->cells = NULL;
+}
+
+int pc_mpmc_try_put(PcMpmcQueue *q, PcItem item) {
+    size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    PcMpmcCell *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        ptrdiff_t dif = (ptrdiff_t)(seq - pos);
+        if (dif == 0) {
+            // The cell is free for position pos: claim it
+            if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return 0; // Still holds the item from one lap ago
+        } else {
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+    cell->item = item;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return 1;
+}
+
+int pc_mpmc_try_get(PcMpmcQueue *q, PcItem *item) {
+    size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    PcMpmcCell *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        ptrdiff_t dif = (ptrdiff_t)(seq - (pos + 1));
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return 0; // Its item has not been stored yet
+        } else {
+            pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+        }
+    }
+    *item = cell->item;
+    // Free the cell for the producer one lap ahead
+    atomic_store_explicit(&cell->seq, pos + q->mask + 1, memory_order_release);
+    return 1;
+}
+
+#define WAIT_SLEEPERS(s) ((s) & 0xffff)
+#define WAIT_PENDING(s)  ((s) >> 16)
+#define WAIT_ONE_PENDING (1u << 16)
+
+// Called after a put (get) with the side that waits for it. The fence pairs
+// with the one in mpmc_sleep(): either the sleeper's last try sees our
+// update, or we see it counted. Every counted sleeper read the event before
+// our bump, so it leaves (woken or not asleep yet) and takes a pending
+// wake-up off the count; 'pending <= sleepers' always holds.
+static void mpmc_wake(PcMpmcWait *w) {
+    atomic_thread_fence(memory_order_seq_cst);
+    unsigned s = atomic_load_explicit(&w->state, memory_order_relaxed);
+    while (WAIT_SLEEPERS(s) > WAIT_PENDING(s)) {
+        if (atomic_compare_exchange_weak(&w->state, &s, s + WAIT_ONE_PENDING)) {
+            atomic_fetch_add(&w->event, 1);
+            futex_wake(&w->event, 1, 0);
+            return;
+        }
+    }
+}
+
+// Count ourselves in, then sleep unless a last try succeeds or a wake-up came
+// in between. Returns whether the last try succeeded.
+static int mpmc_sleep(PcMpmcWait *w, PcMpmcQueue *q, PcItem *item, int get) {
+    unsigned key = atomic_load(&w->event);
+    atomic_fetch_add(&w->state, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    int done = get ? pc_mpmc_try_get(q, item) : pc_mpmc_try_put(q, *item);
+    if (!done) futex_wait(&w->event, key, 0);
+    unsigned s = atomic_load_explicit(&w->state, memory_order_relaxed), next;
+    do {
+        next = s - 1 - (WAIT_PENDING(s) > 0 ? WAIT_ONE_PENDING : 0);
+    } while (!atomic_compare_exchange_weak(&w->state, &s, next));
+    return done;
+}
+
+void pc_mpmc_put(PcMpmcQueue *q, PcItem item) {
+    for (unsigned spins = 0; !pc_mpmc_try_put(q, item); spins++) {
+        if (spins < PC_SPIN_LIMIT) cpu_relax();
+        else if (mpmc_sleep(&q->slots, q, &item, 0)) break;
+    }
+    mpmc_wake(&q->items);
+}
+
+PcItem pc_mpmc_get(PcMpmcQueue *q) {
+    PcItem item;
+    for (unsigned spins = 0; !pc_mpmc_try_get(q, &item); spins++) {
+        if (spins < PC_SPIN_LIMIT) cpu_relax();
+        else if (mpmc_sleep(&q->items, q, &item, 1)) break;
+    }
+    mpmc_wake(&q->slots);
+    return item;
+}
+
+// ===================================================================
+// SPSC ring in a memory-mapped file
+// ===================================================================
+
+// Sleep on 'event' unless '*index' has moved past 'seen' (or the ring is
+// closed) after announcing ourselves in bit 0. The fence pairs with the one
+// in ring_wake(): either we see the other side's update, or it sees the bit.
+static void ring_sleep(atomic_uint *event, _Atomic uint64_t *index, uint64_t seen, atomic_uint *closed) {
+    unsigned v = atomic_fetch_or(event, 1) | 1;
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(index, memory_order_acquire) == seen && !(closed && atomic_load(closed))) {
+        futex_wait(event, v, 1);
+    }
+}
+
+static void ring_wake(atomic_uint *event) {
+    atomic_thread_fence(memory_order_seq_cst);
+    unsigned v = atomic_load_explicit(event, memory_order_relaxed);
+    if ((v & 1) && atomic_compare_exchange_strong(event, &v, (v + 2) & ~1u)) futex_wake(event, INT_MAX, 1);
+}
+
+// Map 'size' bytes of 'fd' and fill in everything but the indices
+static int ring_map(PcFileRing *r, int fd, size_t size, const char *path) {
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+    memset(r, 0, sizeof *r);
+    r->hdr = map;
+    r->slots = (unsigned char *)map + sizeof *r->hdr;
+    r->map_size = size;
+    return 0;
+}
+
+int pc_file_ring_create(PcFileRing *r, const char *path, size_t capacity, size_t record_size) {
+    char tmp[4096];
+    size_t slots = 2, stride = (record_size + 7) & ~(size_t)7;
+    int fd;
+
+    if (record_size == 0 || record_size > (1 << 20) || capacity > ((size_t)1 << 30)) {
+        fprintf(stderr, "%s: invalid ring size (%zu records of %zu bytes)\n", path, capacity, record_size);
+        return -1;
+    }
+    while (slots < capacity) slots <<= 1;
+    size_t size = sizeof(PcFileRingHeader) + slots * stride;
+
+    // Build it under a temporary name and rename it into place when done
+    if (snprintf(tmp, sizeof tmp, "%s.tmp", path) >= (int)sizeof tmp) {
+        fprintf(stderr, "%s: path too long\n", path);
+        return -1;
+    }
+    if ((fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0 || ftruncate(fd, size) != 0) {
+        perror(tmp);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    int rc = ring_map(r, fd, size, tmp);
+    close(fd);
+    if (rc != 0) return -1;
+
+    // ftruncate() zero-filled the file, so the indices start at 0
+    PcFileRingHeader *h = r->hdr;
+    h->record_size = (uint32_t)record_size;
+    h->capacity = slots;
+    h->producer = (int32_t)getpid();
+    memcpy(h->magic, PC_FILE_RING_MAGIC, sizeof h->magic);
+    if (rename(tmp, path) != 0) {
+        perror(path);
+        pc_file_ring_unmap(r);
+        unlink(tmp);
+        return -1;
+    }
+    r->stride = stride;
+    r->mask = slots - 1;
+    return 0;
+}
+
+int pc_file_ring_open(PcFileRing *r, const char *path) {
+    struct stat st;
+    int fd = open(path, O_RDWR);
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    if ((size_t)st.st_size < sizeof(PcFileRingHeader)) {
+        fprintf(stderr, "%s: not a producer/consumer ring\n", path);
+        close(fd);
+        return -1;
+    }
+    int rc = ring_map(r, fd, st.st_size, path);
+    close(fd);
+    if (rc != 0) return -1;
+
+    PcFileRingHeader *h = r->hdr;
+    size_t stride = ((size_t)h->record_size + 7) & ~(size_t)7;
+    if (memcmp(h->magic, PC_FILE_RING_MAGIC, sizeof h->magic) != 0 || h->record_size == 0 ||
+        h->capacity == 0 || (h->capacity & (h->capacity - 1)) ||
+        sizeof *h + h->capacity * stride != (uint64_t)st.st_size) {
+        fprintf(stderr, "%s: not a producer/consumer ring\n", path);
+        pc_file_ring_unmap(r);
+        return -1;
+    }
+    r->stride = stride;
+    r->mask = h->capacity - 1;
+    // Pick up where an earlier producer (consumer) left off. The real tail
+    // is a valid cached value for either side: it makes the consumer look
+    // for the head, and bounds what the producer may fill.
+    r->head = atomic_load(&h->head);
+    r->tail = atomic_load(&h->tail);
+    r->other_cached = r->tail;
+    return 0;
+}
+
+int pc_file_ring_stale(const PcFileRing *r) {
+    pid_t pid = r->hdr->producer;
+    return pid > 0 && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+void pc_file_ring_unmap(PcFileRing *r) {
+    munmap(r->hdr, r->map_size);
+    r->hdr = NULL;
+}
+
+void *pc_file_ring_reserve(PcFileRing *r) {
+    PcFileRingHeader *h = r->hdr;
+    if (r->head - r->other_cached > r->mask) {
+        r->other_cached = atomic_load_explicit(&h->tail, memory_order_acquire);
+        for (unsigned spins = 0; r->head - r->other_cached > r->mask; spins++) {
+            if (spins < PC_SPIN_LIMIT) cpu_relax();
+            else ring_sleep(&h->tail_event, &h->tail, r->other_cached, NULL);
+            r->other_cached = atomic_load_explicit(&h->tail, memory_order_acquire);
+        }
+    }
+    return r->slots + (r->head & r->mask) * r->stride;
+}
+
+void pc_file_ring_commit(PcFileRing *r) {
+    atomic_store_explicit(&r->hdr->head, ++r->head, memory_order_release);
+    ring_wake(&r->hdr->head_event);
+}
+
+void pc_file_ring_close(PcFileRing *r) {
+    atomic_store_explicit(&r->hdr->closed, 1, memory_order_release);
+    ring_wake(&r->hdr->head_event);
+}
+
+const void *pc_file_ring_peek(PcFileRing *r) {
+    PcFileRingHeader *h = r->hdr;
+    if (r->tail == r->other_cached) {
+        r->other_cached = atomic_load_explicit(&h->head, memory_order_acquire);
+        for (unsigned spins = 0; r->tail == r->other_cached; spins++) {
+            if (atomic_load_explicit(&h->closed, memory_order_acquire)) {
+                // Everything was committed before the close
+                r->other_cached = atomic_load_explicit(&h->head, memory_order_acquire);
+                if (r->tail == r->other_cached) return NULL;
+                break;
+            }
+            if (spins < PC_SPIN_LIMIT) cpu_relax();
+            else ring_sleep(&h->head_event, &h->head, r->other_cached, &h->closed);
+            r->other_cached = atomic_load_explicit(&h->head, memory_order_acquire);
+        }
+    }
+    return r->slots + (r->tail & r->mask) * r->stride;
+}
+
+void pc_file_ring_release(PcFileRing *r) {
+    atomic_store_explicit(&r->hdr->tail, ++r->tail, memory_order_release);
+    ring_wake(&r->hdr->tail_event);
+}
+
+// ===================================================================
+// Benchmark
+// ===================================================================
+
+enum { QUEUE_SEM, QUEUE_COND, QUEUE_SPSC, QUEUE_MPMC, NUM_QUEUES };
+
+static const char *const QUEUE_NAMES[] = { "sem", "cond", "spsc", "mpmc" };
+static const char *const QUEUE_TITLES[] = { "mutex+semaphores", "mutex+condvars", "SPSC ring", "MPMC queue" };
+
+// Every SAMPLE_EVERY-th item is timed from just before put to just after get
+#define SAMPLE_EVERY 64
+
+// Producers and consumers per side in one run
+#define PC_MAX_THREADS 64
+#define PC_MAX_CONFIGS 16
+
+// Largest batch for the condition variable buffer
+#define PC_MAX_BATCH 4096
+
+// Consumers stop when they get this instead of an item
+#define PC_DONE ((PcItem)-1)
+
+typedef struct {
+    int queue;           // QUEUE_*
+    int producers;
+    int in_order;        // One producer and one consumer: items arrive in order
+    int batch;           // Items per pc_produce_batch()/pc_consume_batch()
+    long long items;
+    PcSemBuffer sem;
+    PcCondBuffer cond;
+    PcSpscRing spsc;
+    PcMpmcQueue mpmc;
+    long long *sent_ns;  // Per sampled item
+    long long *recv_ns;
+} Bench;
+
+typedef struct {
+    Bench *b;
+    int id;
+    long long count;     // Consumer: items received
+    long long sum;       // Consumer: sum of the items received
+    long long errors;    // Consumer: items out of order (1:1 only)
+} BenchWorker;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void bench_put(Bench *b, PcItem item) {
+    switch (b->queue) {
+        case QUEUE_COND: pc_produce_batch(&b->cond, &item, 1); break;
+        case QUEUE_SPSC: pc_spsc_put(&b->spsc, item); break;
+        case QUEUE_MPMC: pc_mpmc_put(&b->mpmc, item); break;
+        default: pc_sem_put(&b->sem, item); break;
+    }
+}
+
+static PcItem bench_get(Bench *b) {
+    switch (b->queue) {
+        case QUEUE_SPSC: return pc_spsc_get(&b->spsc);
+        case QUEUE_MPMC: return pc_mpmc_get(&b->mpmc);
+        default: return pc_sem_get(&b->sem);
+    }
+}
+
+// Producer k sends items k, k + producers, k + 2 * producers, ...
+static void *bench_producer(void *arg) {
+    BenchWorker *w = arg;
+    Bench *b = w->b;
+    if (b->queue == QUEUE_COND) {
+        PcItem batch[PC_MAX_BATCH];
+        int n = 0;
+        for (PcItem i = w->id; i < b->items; i += b->producers) {
+            if (i % SAMPLE_EVERY == 0) b->sent_ns[i / SAMPLE_EVERY] = now_ns();
+            batch[n++] = i;
+            if (n == b->batch) {
+                pc_produce_batch(&b->cond, batch, n);
+                n = 0;
+            }
+        }
+        pc_produce_batch(&b->cond, batch, n);
+        return NULL;
+    }
+    for (PcItem i = w->id; i < b->items; i += b->producers) {
+        if (i % SAMPLE_EVERY == 0) b->sent_ns[i / SAMPLE_EVERY] = now_ns();
+        bench_put(b, i);
+    }
+    return NULL;
+}
+
+static void bench_received(BenchWorker *w, PcItem item, PcItem *expect) {
+    Bench *b = w->b;
+    if (item % SAMPLE_EVERY == 0) b->recv_ns[item / SAMPLE_EVERY] = now_ns();
+    if (b->in_order && item != (*expect)++) w->errors++;
+    w->count++;
+    w->sum += item;
+}
+
+static void *bench_consumer(void *arg) {
+    BenchWorker *w = arg;
+    Bench *b = w->b;
+    PcItem item, expect = 0;
+    if (b->queue == QUEUE_COND) {
+        PcItem batch[PC_MAX_BATCH];
+        for (;;) {
+            int n = pc_consume_batch(&b->cond, batch, b->batch);
+            for (int i = 0; i < n; i++) {
+                if (batch[i] == PC_DONE) {
+                    // The rest are the other consumers' stop signals: hand them back
+                    pc_produce_batch(&b->cond, batch + i + 1, n - i - 1);
+                    return NULL;
+                }
+                bench_received(w, batch[i], &expect);
+            }
+        }
+    }
+    while ((item = bench_get(b)) != PC_DONE) bench_received(w, item, &expect);
+    return NULL;
+}
+
+static int cmp_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    double seconds;
+    double mean_ns;   // Per-item latency, over the sampled items
+    long long p50_ns;
+    long long p99_ns;
+    long long errors; // Items lost, duplicated, or (1:1) out of order
+} BenchResult;
+
+static int bench_init(Bench *b, int capacity, int publish) {
+    switch (b->queue) {
+        case QUEUE_SPSC: return pc_spsc_init(&b->spsc, capacity, publish);
+        case QUEUE_MPMC: return pc_mpmc_init(&b->mpmc, capacity);
+        case QUEUE_COND: return pc_cond_init(&b->cond, capacity);
+        default: return pc_sem_init(&b->sem, capacity);
+    }
+}
+
+static void bench_destroy(Bench *b) {
+    switch (b->queue) {
+        case QUEUE_SPSC: pc_spsc_destroy(&b->spsc); break;
+        case QUEUE_MPMC: pc_mpmc_destroy(&b->mpmc); break;
+        case QUEUE_COND: pc_cond_destroy(&b->cond); break;
+        default: pc_sem_destroy(&b->sem); break;
+    }
+}
+
+static int bench_run(int queue, int producers, int consumers, int batch, long long items, int capacity,
+                     int publish, BenchResult *res) {
+    Bench b;
+    pthread_t prod[PC_MAX_THREADS], cons[PC_MAX_THREADS];
+    BenchWorker pw[PC_MAX_THREADS], cw[PC_MAX_THREADS];
+    long long samples = (items + SAMPLE_EVERY - 1) / SAMPLE_EVERY;
+    int started = 0;
+
+    memset(&b, 0, sizeof b);
+    b.queue = queue;
+    b.producers = producers;
+    b.in_order = producers == 1 && consumers == 1;
+    b.batch = batch;
+    b.items = items;
+    b.sent_ns = calloc(samples, sizeof *b.sent_ns);
+    b.recv_ns = calloc(samples, sizeof *b.recv_ns);
+    if (!b.sent_ns || !b.recv_ns || bench_init(&b, capacity, publish) != 0) {
+        free(b.sent_ns);
+        free(b.recv_ns);
+        return -1;
+    }
+
+    long long t0 = now_ns();
+    for (; started < consumers; started++) {
+        cw[started] = (BenchWorker){ &b, started, 0, 0, 0 };
+        if (pthread_create(&cons[started], NULL, bench_consumer, &cw[started]) != 0) break;
+    }
+    if (started == consumers) {
+        for (int i = 0; i < producers; i++) {
+            pw[i] = (BenchWorker){ &b, i, 0, 0, 0 };
+            if (pthread_create(&prod[i], NULL, bench_producer, &pw[i]) != 0) {
+                bench_producer(&pw[i]); // Still send its share, so the consumers finish
+                prod[i] = 0;
+            }
+        }
+        for (int i = 0; i < producers; i++) {
+            if (prod[i]) pthread_join(prod[i], NULL);
+        }
+    }
+    // The producers are done (or never started): this thread takes their
+    // place to stop the consumers, which also covers the single-producer ring
+    for (int i = 0; i < started; i++) bench_put(&b, PC_DONE);
+    if (queue == QUEUE_SPSC) pc_spsc_flush(&b.spsc);
+    for (int i = 0; i < started; i++) pthread_join(cons[i], NULL);
+    res->seconds = (now_ns() - t0) / 1e9;
+
+    if (started == consumers) {
+        long long count = 0, sum = 0, errors = 0;
+        double total = 0;
+        for (int i = 0; i < consumers; i++) {
+            count += cw[i].count;
+            sum += cw[i].sum;
+            errors += cw[i].errors;
+        }
+        if (count != items || sum != items * (items - 1) / 2) errors += count != items ? llabs(count - items) : 1;
+        for (long long i = 0; i < samples; i++) {
+            b.sent_ns[i] = b.recv_ns[i] - b.sent_ns[i];
+            total += b.sent_ns[i];
+        }
+        qsort(b.sent_ns, samples, sizeof *b.sent_ns, cmp_ll);
+        res->mean_ns = total / samples;
+        res->p50_ns = b.sent_ns[samples / 2];
+        res->p99_ns = b.sent_ns[(samples - 1) * 99 / 100];
+        res->errors = errors;
+    }
+    bench_destroy(&b);
+    free(b.sent_ns);
+    free(b.recv_ns);
+    return started == consumers ? 0 : -1;
+}
+
+static void batch_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s -b [-q QUEUES] [-t THREADS] [-k BATCHES] [-n ITEMS] [-c CAPACITY] [-P PUBLISH]\n"
+            "  -b           benchmark: producers and consumers without the sleeps\n"
+            "  -q QUEUES    comma-separated list: sem (mutex+semaphores), cond (mutex+condvars,\n"
+            "               in batches), spsc (lock-free ring, one producer and one consumer only),\n"
+            "               mpmc (lock-free queue); default: all\n"
+            "  -t THREADS   comma-separated runs, each N (N producers, N consumers) or P:C,\n"
+            "               up to %d per side, e.g. 1,2,4,8,16,32,64 (default 1)\n"
+            "  -k BATCHES   cond: comma-separated batch sizes, one run each, up to %d\n"
+            "               (default 1), e.g. 1,2,4,8,16,32,64,128,256\n"
+            "  -n ITEMS     items to pass through each queue per run (default 2000000)\n"
+            "  -c CAPACITY  slots in the queue (default 1024)\n"
+            "  -P PUBLISH   SPSC: publish the indices every PUBLISH items (default 32)\n",
+            prog, PC_MAX_THREADS, PC_MAX_BATCH);
+}
+
+// Parse "sem,spsc" into a QUEUE_* mask; returns 0 if a name is unknown
+static unsigned parse_queue_list(const char *list) {
+    unsigned mask = 0;
+    char name[16];
+    while (*list) {
+        size_t len = strcspn(list, ",");
+        int q;
+        if (len == 0 || len >= sizeof name) return 0;
+        memcpy(name, list, len);
+        name[len] = '\0';
+        for (q = 0; q < NUM_QUEUES && strcmp(name, QUEUE_NAMES[q]) != 0; q++) {}
+        if (q == NUM_QUEUES) {
+            fprintf(stderr, "Unknown queue \"%s\"\n", name);
+            return 0;
+        }
+        mask |= 1u << q;
+        list += len;
+        if (*list == ',') list++;
+    }
+    return mask;
+}
+
+// Parse "1,8,64" into batch sizes; returns how many, or -1
+static int parse_batch_list(const char *list, int batches[]) {
+    int n = 0;
+    while (*list) {
+        char *end;
+        long k = strtol(list, &end, 10);
+        if (end == list || (*end && *end != ',') || k < 1 || k > PC_MAX_BATCH || n == PC_MAX_CONFIGS) {
+            fprintf(stderr, "Invalid batch list \"%s\" (1..%d, at most %d sizes)\n", list, PC_MAX_BATCH,
+                    PC_MAX_CONFIGS);
+            return -1;
+        }
+        batches[n++] = (int)k;
+        list = *end ? end + 1 : end;
+    }
+    return n;
+}
+
+// Parse "1,2,4:1" into producer/consumer counts; returns how many, or -1
+static int parse_thread_list(const char *list, int producers[], int consumers[]) {
+    int n = 0;
+    while (*list) {
+        char *end;
+        long p = strtol(list, &end, 10), c = p;
+        if (*end == ':') c = strtol(end + 1, &end, 10);
+        if (end == list || (*end && *end != ',') || p < 1 || c < 1 || p > PC_MAX_THREADS ||
+            c > PC_MAX_THREADS || n == PC_MAX_CONFIGS) {
+            fprintf(stderr, "Invalid thread list \"%s\" (N or P:C, 1..%d, at most %d runs)\n", list,
+                    PC_MAX_THREADS, PC_MAX_CONFIGS);
+            return -1;
+        }
+        producers[n] = (int)p;
+        consumers[n++] = (int)c;
+        list = *end ? end + 1 : end;
+    }
+    return n;
+}
+
+int pc_batch_main(int argc, char *argv[]) {
+    long long items = 2000000;
+    int capacity = 1024, publish = 32, bench = 0;
+    int producers[PC_MAX_CONFIGS] = { 1 }, consumers[PC_MAX_CONFIGS] = { 1 }, num_configs = 1;
+    int batches[PC_MAX_CONFIGS] = { 1 }, num_batches = 1;
+    unsigned queues = (1u << NUM_QUEUES) - 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "bq:t:k:n:c:P:h")) != -1) {
+        switch (opt) {
+            case 'b': bench = 1; break;
+            case 'q':
+                if (!(queues = parse_queue_list(optarg))) return 1;
+                break;
+            case 't':
+                if ((num_configs = parse_thread_list(optarg, producers, consumers)) <= 0) return 1;
+                break;
+            case 'k':
+                if ((num_batches = parse_batch_list(optarg, batches)) <= 0) return 1;
+                break;
+            case 'n':
+            case 'c':
+            case 'P': {
+                long long v = atoll(optarg);
+                if (v <= 0 || (opt != 'n' && v > (1 << 24))) {
+                    fprintf(stderr, "Invalid value \"%s\" for -%c\n", optarg, opt);
+                    return 1;
+                }
+                if (opt == 'n') items = v;
+                else if (opt == 'c') capacity = (int)v;
+                else publish = (int)v;
+                break;
+            }
+            default:
+                batch_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (!bench || optind != argc) {
+        batch_usage(argv[0]);
+        return 1;
+    }
+
+    printf("\n--- Producer/Consumer Benchmark (%lld items, capacity %d) ---\n", items, capacity);
+    printf("+------------------+-----------+-------+-------------+------------+------------+------------+------------+\n");
+    printf("| Queue            | Prod:Cons | Batch | Items/s     | Time (s)   | Mean (ns)  | p50 (ns)   | p99 (ns)   |\n");
+    printf("+------------------+-----------+-------+-------------+------------+------------+------------+------------+\n");
+    for (int t = 0; t < num_configs; t++) {
+        for (int q = 0; q < NUM_QUEUES; q++) {
+            if (!(queues & (1u << q))) continue;
+            if (q == QUEUE_SPSC && (producers[t] != 1 || consumers[t] != 1)) continue;
+            // Only the condition variable buffer moves items in batches
+            for (int k = 0; k < (q == QUEUE_COND ? num_batches : 1); k++) {
+                int batch = q == QUEUE_COND ? batches[k] : 1;
+                BenchResult res;
+                char threads[16];
+                if (bench_run(q, producers[t], consumers[t], batch, items, capacity, publish, &res) != 0) {
+                    fprintf(stderr, "Could not set up the %s queue with %d:%d threads.\n", QUEUE_TITLES[q],
+                            producers[t], consumers[t]);
+                    return 1;
+                }
+                snprintf(threads, sizeof threads, "%d:%d", producers[t], consumers[t]);
+                printf("| %-16s | %-9s | %5d | %11.0f | %10.3f | %10.0f | %10lld | %10lld |\n", QUEUE_TITLES[q],
+                       threads, batch, res.seconds > 0 ? items / res.seconds : 0, res.seconds, res.mean_ns,
+                       res.p50_ns, res.p99_ns);
+                if (res.errors) printf("  (%lld items lost, duplicated or out of order!)\n", res.errors);
+                fflush(stdout);
+            }
+        }
+    }
+    printf("+------------------+-----------+-------+-------------+------------+------------+------------+------------+\n");
+    printf("Latency is measured on every %dth item, from just before put to just after get;\n"
+           "producers running ahead of the consumers keep the queue full, so it includes queueing,\n"
+           "and a batch holds its first items back until it is full.\n", SAMPLE_EVERY);
+    return 0;
+}
@@ -0,0 +1,177 @@
+// pcqueue.h — bounded producer/consumer queues used by 4.1.c and 4.3.c
+//
+// The classic mutex + two counting semaphores buffer of 4.1.c, next to a
+// batched mutex + condition variable buffer, a lock-free
+// single-producer/single-consumer ring and a lock-free bounded
+// multi-producer/multi-consumer queue, and a benchmark driver that times
+// them without the demo's sleeps. A single-producer/single-consumer ring can
+// also live in a memory-mapped file, shared by threads or processes.
+#ifndef PCQUEUE_H
+#define PCQUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#define PC_CACHE_LINE 64
+
+typedef long long PcItem;
+
+// --- Mutex + counting semaphores (one sem_wait/lock/unlock/sem_post per item) ---
+typedef struct {
+    PcItem *buf;
+    int size;
+    int in;              // Next slot the producers fill
+    int out;             // Next slot the consumers empty
+    pthread_mutex_t lock;
+    sem_t empty_slots;
+    sem_t full_slots;
+} PcSemBuffer;
+
+// All return 0 on success, -1 on failure
+int    pc_sem_init(PcSemBuffer *b, int size);
+void   pc_sem_destroy(PcSemBuffer *b);
+void   pc_sem_put(PcSemBuffer *b, PcItem item);
+PcItem pc_sem_get(PcSemBuffer *b);
+
+// --- Mutex + condition variables, moving items in batches ---
+// A semaphore can only be taken one unit at a time, so claiming k slots at
+// once needs the counts under the mutex instead: each call below moves as
+// many items as fit in one lock/unlock, then wakes at most that many waiters.
+typedef struct {
+    PcItem *buf;
+    int size;
+    int in;
+    int out;
+    int count;           // Items in the buffer
+    int producers_waiting;
+    int consumers_waiting;
+    pthread_mutex_t lock;
+    pthread_cond_t not_full;
+    pthread_cond_t not_empty;
+} PcCondBuffer;
+
+int  pc_cond_init(PcCondBuffer *b, int size);
+void pc_cond_destroy(PcCondBuffer *b);
+// Puts all n items, as many per lock round-trip as there are free slots
+void pc_produce_batch(PcCondBuffer *b, const PcItem *items, int n);
+// Waits for at least one item, then takes up to 'max'; returns how many
+int  pc_consume_batch(PcCondBuffer *b, PcItem *items, int max);
+
+// --- Lock-free single-producer/single-consumer ring ---
+// Each side owns one index and keeps a private copy of the other's, so the
+// shared indices are only read when the copy says the ring is full (empty).
+// A side publishes its index every 'publish' items, and whenever it is about
+// to wait, so one cache-line transfer covers a whole batch. The indices live
+// on separate cache lines so the two threads never write the same line.
+typedef struct {
+    _Alignas(PC_CACHE_LINE) atomic_size_t in; // Items published by the producer
+    size_t in_local;     // Producer: items written (published or not)
+    size_t out_cached;   // Producer: last value read of 'out'
+    _Alignas(PC_CACHE_LINE) atomic_size_t out; // Items released by the consumer
+    size_t out_local;    // Consumer: items read
+    size_t in_cached;    // Consumer: last value read of 'in'
+    _Alignas(PC_CACHE_LINE) PcItem *buf;
+    size_t mask;         // Capacity - 1 (a power of two)
+    size_t publish;      // Publish the index every this many items
+} PcSpscRing;
+
+// 'capacity' is rounded up to a power of two; 'publish' 1 publishes every item
+int    pc_spsc_init(PcSpscRing *r, size_t capacity, size_t publish);
+void   pc_spsc_destroy(PcSpscRing *r);
+void   pc_spsc_put(PcSpscRing *r, PcItem item); // Producer only; waits while full
+PcItem pc_spsc_get(PcSpscRing *r);              // Consumer only; waits while empty
+void   pc_spsc_flush(PcSpscRing *r);            // Producer: publish everything written
+
+// --- Lock-free multi-producer/multi-consumer queue (Vyukov) ---
+// Every cell carries a sequence number that says whose turn it is: 'pos'
+// when it is free for the producer that claims position pos, 'pos + 1' once
+// that item is in it. Producers and consumers each claim positions with a
+// compare-and-swap on their own counter and never touch each other's.
+// Threads that find the queue full (empty) spin briefly, then sleep on a
+// futex. The other side wakes one sleeper per item (slot), and only makes
+// the system call while there are more sleepers than wake-ups on their way.
+typedef struct {
+    atomic_uint event;   // Futex word, bumped on every wake-up
+    atomic_uint state;   // Low 16 bits: sleepers; high 16 bits: wake-ups pending
+} PcMpmcWait;
+
+typedef struct {
+    atomic_size_t seq;
+    PcItem item;
+} PcMpmcCell;
+
+typedef struct {
+    _Alignas(PC_CACHE_LINE) atomic_size_t enqueue_pos;
+    _Alignas(PC_CACHE_LINE) atomic_size_t dequeue_pos;
+    _Alignas(PC_CACHE_LINE) PcMpmcWait items;          // Consumers sleep here
+    PcMpmcWait slots;                                  // Producers sleep here
+    _Alignas(PC_CACHE_LINE) PcMpmcCell *cells;
+    size_t mask;
+} PcMpmcQueue;
+
+// 'capacity' is rounded up to a power of two
+int    pc_mpmc_init(PcMpmcQueue *q, size_t capacity);
+void   pc_mpmc_destroy(PcMpmcQueue *q);
+int    pc_mpmc_try_put(PcMpmcQueue *q, PcItem item);  // 1 if stored, 0 if full
+int    pc_mpmc_try_get(PcMpmcQueue *q, PcItem *item); // 1 if taken, 0 if empty
+void   pc_mpmc_put(PcMpmcQueue *q, PcItem item);      // Waits while full
+PcItem pc_mpmc_get(PcMpmcQueue *q);                   // Waits while empty
+
+// --- Single-producer/single-consumer ring in a memory-mapped file ---
+// The file is the header below followed by 'capacity' slots of 'record_size'
+// bytes (rounded up to 8). Both sides work on the mapping directly: the
+// producer fills the slot pc_file_ring_reserve() returns and publishes it
+// with pc_file_ring_commit(); the consumer reads pc_file_ring_peek() and
+// frees it with pc_file_ring_release(). Up to 'capacity' records can be in
+// flight, and the futex words work across processes mapping the same file.
+#define PC_FILE_RING_MAGIC "PCRG"
+
+typedef struct {
+    char magic[4];             // PC_FILE_RING_MAGIC, written last by pc_file_ring_create()
+    uint32_t record_size;
+    uint64_t capacity;         // Slots, a power of two
+    int32_t producer;          // pid of the process that created the ring
+    _Alignas(PC_CACHE_LINE) _Atomic uint64_t head; // Records committed by the producer
+    atomic_uint head_event;    // Futex word the consumer sleeps on (bit 0: asleep)
+    atomic_uint closed;        // The producer has finished
+    _Alignas(PC_CACHE_LINE) _Atomic uint64_t tail; // Records released by the consumer
+    atomic_uint tail_event;    // Futex word the producer sleeps on (bit 0: asleep)
+} PcFileRingHeader;
+
+typedef struct {
+    PcFileRingHeader *hdr;     // Start of the mapping
+    unsigned char *slots;
+    size_t map_size;
+    size_t stride;             // Bytes per slot
+    uint64_t mask;             // capacity - 1
+    uint64_t head;             // Producer: records committed
+    uint64_t tail;             // Consumer: records released
+    uint64_t other_cached;     // Last value read of the other side's index
+} PcFileRing;
+
+// Create (or replace) 'path' with an empty ring; 'capacity' is rounded up
+// to a power of two. The file appears only once it is fully set up, so a
+// consumer waiting for it never sees a half-written header.
+int  pc_file_ring_create(PcFileRing *r, const char *path, size_t capacity, size_t record_size);
+// Attach to a ring another thread or process created
+int  pc_file_ring_open(PcFileRing *r, const char *path);
+// 1 if the process that created the ring has exited, e.g. a ring left over
+// from an interrupted run: nothing will be committed to it any more
+int  pc_file_ring_stale(const PcFileRing *r);
+void pc_file_ring_unmap(PcFileRing *r);
+
+void *pc_file_ring_reserve(PcFileRing *r);       // Producer: next free slot; waits while full
+void  pc_file_ring_commit(PcFileRing *r);        // Producer: publish the reserved slot
+void  pc_file_ring_close(PcFileRing *r);         // Producer: no more records
+const void *pc_file_ring_peek(PcFileRing *r);    // Consumer: next record; waits while empty,
+                                                 // NULL once closed and drained
+void  pc_file_ring_release(PcFileRing *r);       // Consumer: done with the peeked record
+
+// --- Benchmark ---
+// Non-interactive entry point used when 4.1 is started with arguments
+int pc_batch_main(int argc, char *argv[]);
+
+#endif
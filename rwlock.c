@@ -0,0 +1,659 @@
+// rwlock.c — readers-writers locks and their benchmark
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>   // INT_MAX
+#include <stdatomic.h>
+#include <semaphore.h>
+#include <sched.h>    // sched_yield
+#include <time.h>     // clock_gettime, nanosleep
+#include <unistd.h>   // getopt, syscall
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#include "rwlock.h"
+
+#define RW_CACHE_LINE 64
+
+// Busy-wait rounds before a waiting thread goes to sleep
+#define RW_SPIN_LIMIT 64
+
+static void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+#ifdef __linux__
+static void futex_wait(atomic_uint *word, unsigned expected) {
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint *word, int count) {
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+#else
+// No futex: sleeping turns into yielding until the word changes
+static void futex_wait(atomic_uint *word, unsigned expected) {
+    while (atomic_load(word) == expected) sched_yield();
+}
+
+static void futex_wake(atomic_uint *word, int count) {
+    (void)word;
+    (void)count;
+}
+#endif
+
+// ===================================================================
+// Reader priority (4.4.c's solution)
+// ===================================================================
+
+typedef struct {
+    pthread_mutex_t read_count_mutex; // Protects read_count
+    int read_count;                   // Readers inside
+    sem_t db_access;                  // Held by a writer, or by the readers as a group
+} ReaderPrioState;
+
+static int reader_prio_init(RwLock *l) {
+    ReaderPrioState *s = malloc(sizeof *s);
+    if (!s) return -1;
+    s->read_count = 0;
+    if (pthread_mutex_init(&s->read_count_mutex, NULL) != 0) {
+        free(s);
+        return -1;
+    }
+    if (sem_init(&s->db_access, 0, 1) != 0) {
+        pthread_mutex_destroy(&s->read_count_mutex);
+        free(s);
+        return -1;
+    }
+    l->state = s;
+    return 0;
+}
+
+static void reader_prio_destroy(RwLock *l) {
+    ReaderPrioState *s = l->state;
+    sem_destroy(&s->db_access);
+    pthread_mutex_destroy(&s->read_count_mutex);
+    free(s);
+}
+
+static void reader_prio_read_lock(RwLock *l) {
+    ReaderPrioState *s = l->state;
+    pthread_mutex_lock(&s->read_count_mutex);
+    if (++s->read_count == 1) sem_wait(&s->db_access); // First reader locks writers out
+    pthread_mutex_unlock(&s->read_count_mutex);
+}
+
+static void reader_prio_read_unlock(RwLock *l) {
+    ReaderPrioState *s = l->state;
+    pthread_mutex_lock(&s->read_count_mutex);
+    if (--s->read_count == 0) sem_post(&s->db_access); // Last reader lets them in
+    pthread_mutex_unlock(&s->read_count_mutex);
+}
+
+static void reader_prio_write_lock(RwLock *l) {
+    sem_wait(&((ReaderPrioState *)l->state)->db_access);
+}
+
+static void reader_prio_write_unlock(RwLock *l) {
+    sem_post(&((ReaderPrioState *)l->state)->db_access);
+}
+
+const RwPolicy RW_READER_PRIORITY = {
+    "reader", "Reader priority",
+    reader_prio_init, reader_prio_destroy,
+    reader_prio_read_lock, reader_prio_read_unlock,
+    reader_prio_write_lock, reader_prio_write_unlock,
+};
+
+// ===================================================================
+// Writer priority
+// ===================================================================
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t readers_ok;
+    pthread_cond_t writers_ok;
+    int readers;          // Readers inside
+    int writer;           // A writer is inside
+    int writers_waiting;  // Writers queued; new readers wait behind them
+} WriterPrioState;
+
+static int writer_prio_init(RwLock *l) {
+    WriterPrioState *s = calloc(1, sizeof *s);
+    if (!s) return -1;
+    if (pthread_mutex_init(&s->lock, NULL) != 0) {
+        free(s);
+        return -1;
+    }
+    if (pthread_cond_init(&s->readers_ok, NULL) != 0) {
+        pthread_mutex_destroy(&s->lock);
+        free(s);
+        return -1;
+    }
+    if (pthread_cond_init(&s->writers_ok, NULL) != 0) {
+        pthread_cond_destroy(&s->readers_ok);
+        pthread_mutex_destroy(&s->lock);
+        free(s);
+        return -1;
+    }
+    l->state = s;
+    return 0;
+}
+
+static void writer_prio_destroy(RwLock *l) {
+    WriterPrioState *s = l->state;
+    pthread_cond_destroy(&s->readers_ok);
+    pthread_cond_destroy(&s->writers_ok);
+    pthread_mutex_destroy(&s->lock);
+    free(s);
+}
+
+static void writer_prio_read_lock(RwLock *l) {
+    WriterPrioState *s = l->state;
+    pthread_mutex_lock(&s->lock);
+    while (s->writer || s->writers_waiting) pthread_cond_wait(&s->readers_ok, &s->lock);
+    s->readers++;
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void writer_prio_read_unlock(RwLock *l) {
+    WriterPrioState *s = l->state;
+    pthread_mutex_lock(&s->lock);
+    if (--s->readers == 0 && s->writers_waiting) pthread_cond_signal(&s->writers_ok);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void writer_prio_write_lock(RwLock *l) {
+    WriterPrioState *s = l->state;
+    pthread_mutex_lock(&s->lock);
+    s->writers_waiting++;
+    while (s->writer || s->readers) pthread_cond_wait(&s->writers_ok, &s->lock);
+    s->writers_waiting--;
+    s->writer = 1;
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void writer_prio_write_unlock(RwLock *l) {
+    WriterPrioState *s = l->state;
+    pthread_mutex_lock(&s->lock);
+    s->writer = 0;
+    // The next writer first; readers only once no writer is queued
+    if (s->writers_waiting) pthread_cond_signal(&s->writers_ok);
+    else pthread_cond_broadcast(&s->readers_ok);
+    pthread_mutex_unlock(&s->lock);
+}
+
+const RwPolicy RW_WRITER_PRIORITY = {
+    "writer", "Writer priority",
+    writer_prio_init, writer_prio_destroy,
+    writer_prio_read_lock, writer_prio_read_unlock,
+    writer_prio_write_lock, writer_prio_write_unlock,
+};
+
+// ===================================================================
+// Phase-fair ticket lock
+// ===================================================================
+
+// Brandenburg and Anderson's PF-T lock. Readers count themselves in 'rin'
+// and out in 'rout' in steps of PF_RINC; the low bits of 'rin' say that a
+// writer is present and which phase it belongs to. Readers arriving while
+// a writer is present wait for that one writer only (the phase bit flips),
+// and writers queue on the win/wout ticket pair, so once readers hold the
+// lock a writer gets it next, and once a writer holds it the readers that
+// came meanwhile get it next. Waiters spin briefly, then sleep on a futex
+// word that the unlocks bump when someone is asleep on it.
+#define PF_RINC  0x100u // Reader increment
+#define PF_WBITS 0x3u   // Writer bits in rin
+#define PF_PRES  0x2u   // A writer is present
+#define PF_PHID  0x1u   // Phase id of that writer
+
+typedef struct {
+    _Alignas(RW_CACHE_LINE) atomic_uint rin;
+    _Alignas(RW_CACHE_LINE) atomic_uint rout;
+    _Alignas(RW_CACHE_LINE) atomic_uint win;
+    _Alignas(RW_CACHE_LINE) atomic_uint wout;
+    _Alignas(RW_CACHE_LINE) atomic_uint readers_event; // Readers sleep here (bit 0: asleep)
+    atomic_uint writers_event;                         // Writers sleep here (bit 0: asleep)
+} PhaseFairState;
+
+static int phase_fair_init(RwLock *l) {
+    PhaseFairState *s = aligned_alloc(RW_CACHE_LINE, sizeof *s);
+    if (!s) return -1;
+    atomic_init(&s->rin, 0);
+    atomic_init(&s->rout, 0);
+    atomic_init(&s->win, 0);
+    atomic_init(&s->wout, 0);
+    atomic_init(&s->readers_event, 0);
+    atomic_init(&s->writers_event, 0);
+    l->state = s;
+    return 0;
+}
+
+static void phase_fair_destroy(RwLock *l) {
+    free(l->state);
+}
+
+// Called with '*word & mask' equal to 'seen': spin a while, then sleep on
+// 'event' unless it has changed after announcing ourselves in bit 0. The
+// fence pairs with the one in pf_wake(): either we see the unlock's update,
+// or it sees the bit (as pcqueue.c's file ring does).
+static void pf_wait(atomic_uint *event, atomic_uint *word, unsigned mask, unsigned seen, unsigned *spins) {
+    if (++*spins < RW_SPIN_LIMIT) {
+        cpu_relax();
+        return;
+    }
+    unsigned v = atomic_fetch_or(event, 1) | 1;
+    atomic_thread_fence(memory_order_seq_cst);
+    if ((atomic_load_explicit(word, memory_order_acquire) & mask) == seen) futex_wait(event, v);
+}
+
+// After changing a word someone may wait on: wake every sleeper, if any
+static void pf_wake(atomic_uint *event) {
+    atomic_thread_fence(memory_order_seq_cst);
+    unsigned v = atomic_load_explicit(event, memory_order_relaxed);
+    if ((v & 1) && atomic_compare_exchange_strong(event, &v, (v + 2) & ~1u)) futex_wake(event, INT_MAX);
+}
+
+static void phase_fair_read_lock(RwLock *l) {
+    PhaseFairState *s = l->state;
+    unsigned w = atomic_fetch_add(&s->rin, PF_RINC) & PF_WBITS;
+    unsigned spins = 0;
+    // Wait out the present writer, not any that arrive after it
+    if (w) while (w == (atomic_load_explicit(&s->rin, memory_order_acquire) & PF_WBITS)) {
+        pf_wait(&s->readers_event, &s->rin, PF_WBITS, w, &spins);
+    }
+}
+
+static void phase_fair_read_unlock(RwLock *l) {
+    PhaseFairState *s = l->state;
+    atomic_fetch_add_explicit(&s->rout, PF_RINC, memory_order_release);
+    pf_wake(&s->writers_event); // A writer may be waiting for the readers to leave
+}
+
+static void phase_fair_write_lock(RwLock *l) {
+    PhaseFairState *s = l->state;
+    unsigned ticket = atomic_fetch_add(&s->win, 1);
+    unsigned spins = 0, v;
+    while ((v = atomic_load_explicit(&s->wout, memory_order_acquire)) != ticket) {
+        pf_wait(&s->writers_event, &s->wout, ~0u, v, &spins);
+    }
+    // Block new readers, then wait for the ones already inside to leave
+    unsigned readers = atomic_fetch_add(&s->rin, PF_PRES | (ticket & PF_PHID));
+    while ((v = atomic_load_explicit(&s->rout, memory_order_acquire)) != readers) {
+        pf_wait(&s->writers_event, &s->rout, ~0u, v, &spins);
+    }
+}
+
+static void phase_fair_write_unlock(RwLock *l) {
+    PhaseFairState *s = l->state;
+    atomic_fetch_and(&s->rin, ~PF_WBITS);
+    atomic_fetch_add_explicit(&s->wout, 1, memory_order_release);
+    pf_wake(&s->readers_event);
+    pf_wake(&s->writers_event);
+}
+
+const RwPolicy RW_PHASE_FAIR = {
+    "fair", "Phase-fair ticket",
+    phase_fair_init, phase_fair_destroy,
+    phase_fair_read_lock, phase_fair_read_unlock,
+    phase_fair_write_lock, phase_fair_write_unlock,
+};
+
+// ===================================================================
+// pthread_rwlock_t
+// ===================================================================
+
+static int pthread_rw_init(RwLock *l) {
+    pthread_rwlock_t *s = malloc(sizeof *s);
+    if (!s) return -1;
+    if (pthread_rwlock_init(s, NULL) != 0) {
+        free(s);
+        return -1;
+    }
+    l->state = s;
+    return 0;
+}
+
+static void pthread_rw_destroy(RwLock *l) {
+    pthread_rwlock_destroy(l->state);
+    free(l->state);
+}
+
+static void pthread_rw_read_lock(RwLock *l) {
+    pthread_rwlock_rdlock(l->state);
+}
+
+static void pthread_rw_write_lock(RwLock *l) {
+    pthread_rwlock_wrlock(l->state);
+}
+
+static void pthread_rw_unlock(RwLock *l) {
+    pthread_rwlock_unlock(l->state);
+}
+
+const RwPolicy RW_PTHREAD = {
+    "pthread", "pthread_rwlock_t",
+    pthread_rw_init, pthread_rw_destroy,
+    pthread_rw_read_lock, pthread_rw_unlock,
+    pthread_rw_write_lock, pthread_rw_unlock,
+};
+
+// ===================================================================
+// Policy table
+// ===================================================================
+
+const RwPolicy *const RW_POLICIES[] = { &RW_READER_PRIORITY, &RW_WRITER_PRIORITY, &RW_PHASE_FAIR, &RW_PTHREAD };
+const int RW_NUM_POLICIES = sizeof RW_POLICIES / sizeof RW_POLICIES[0];
+
+const RwPolicy *rw_policy_by_name(const char *name) {
+    for (int i = 0; i < RW_NUM_POLICIES; i++) {
+        if (strcmp(RW_POLICIES[i]->name, name) == 0) return RW_POLICIES[i];
+    }
+    fprintf(stderr, "Unknown lock \"%s\" (", name);
+    for (int i = 0; i < RW_NUM_POLICIES; i++) fprintf(stderr, "%s%s", i ? ", " : "", RW_POLICIES[i]->name);
+    fprintf(stderr, ")\n");
+    return NULL;
+}
+
+int rw_init(RwLock *l, const RwPolicy *pol) {
+    l->pol = pol;
+    l->state = NULL;
+    return pol->init(l);
+}
+
+void rw_destroy(RwLock *l) {
+    l->pol->destroy(l);
+    l->state = NULL;
+}
+
+// ===================================================================
+// Benchmark
+// ===================================================================
+
+// Reader:writer thread mixes in one run
+#define RW_MAX_THREADS 256
+#define RW_MAX_MIXES 16
+#define RW_MAX_BATCH_LOCKS 8
+
+// Seats of the "flight" the threads share; a writer books one on every
+// row, so a reader that sees rows disagree saw a write half done
+#define RW_TABLE_ROWS 16
+
+typedef struct {
+    RwLock lock;
+    int table[RW_TABLE_ROWS];
+    atomic_int stop;
+    // Start gate: the threads wait here until main has started all it can
+    pthread_mutex_t gate_lock;
+    pthread_cond_t gate_cond;
+    int gate_open;
+} RwBench;
+
+typedef struct {
+    RwBench *b;
+    long long ops;
+    long long torn;      // Reader: inconsistent snapshots seen
+    long long *waits;    // Writer: ns from asking for the lock to holding it
+    long long num_waits;
+    long long cap_waits;
+} RwWorker;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void gate_wait(RwBench *b) {
+    pthread_mutex_lock(&b->gate_lock);
+    while (!b->gate_open) pthread_cond_wait(&b->gate_cond, &b->gate_lock);
+    pthread_mutex_unlock(&b->gate_lock);
+}
+
+static void gate_release(RwBench *b) {
+    pthread_mutex_lock(&b->gate_lock);
+    b->gate_open = 1;
+    pthread_cond_broadcast(&b->gate_cond);
+    pthread_mutex_unlock(&b->gate_lock);
+}
+
+static void *bench_reader(void *arg) {
+    RwWorker *w = arg;
+    RwBench *b = w->b;
+    const RwPolicy *pol = b->lock.pol;
+    gate_wait(b);
+    while (!atomic_load_explicit(&b->stop, memory_order_relaxed)) {
+        pol->read_lock(&b->lock);
+        int first = b->table[0], same = 1;
+        for (int i = 1; i < RW_TABLE_ROWS; i++) same &= b->table[i] == first;
+        pol->read_unlock(&b->lock);
+        w->torn += !same;
+        w->ops++;
+    }
+    return NULL;
+}
+
+static void *bench_writer(void *arg) {
+    RwWorker *w = arg;
+    RwBench *b = w->b;
+    const RwPolicy *pol = b->lock.pol;
+    gate_wait(b);
+    while (!atomic_load_explicit(&b->stop, memory_order_relaxed)) {
+        long long t0 = now_ns();
+        pol->write_lock(&b->lock);
+        long long waited = now_ns() - t0;
+        for (int i = 0; i < RW_TABLE_ROWS; i++) b->table[i]++;
+        pol->write_unlock(&b->lock);
+        w->ops++;
+        if (w->num_waits == w->cap_waits) {
+            long long cap = w->cap_waits ? 2 * w->cap_waits : 4096;
+            long long *grown = realloc(w->waits, cap * sizeof *grown);
+            if (!grown) continue; // Keep going; this wait just isn't recorded
+            w->waits = grown;
+            w->cap_waits = cap;
+        }
+        w->waits[w->num_waits++] = waited;
+    }
+    return NULL;
+}
+
+static int cmp_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    double seconds;
+    long long reads, writes;
+    double wait_mean_ns;  // Writer waits
+    long long wait_p99_ns;
+    long long wait_max_ns;
+    long long torn;
+} RwBenchResult;
+
+static int bench_run(const RwPolicy *pol, int readers, int writers, int ms, RwBenchResult *res) {
+    RwBench b;
+    pthread_t th[2 * RW_MAX_THREADS];
+    RwWorker w[2 * RW_MAX_THREADS];
+    int n = readers + writers, started = 0, rc = 0;
+
+    memset(&b, 0, sizeof b);
+    memset(w, 0, n * sizeof *w);
+    memset(res, 0, sizeof *res);
+    atomic_init(&b.stop, 0);
+    if (rw_init(&b.lock, pol) != 0) return -1;
+    if (pthread_mutex_init(&b.gate_lock, NULL) != 0) {
+        rw_destroy(&b.lock);
+        return -1;
+    }
+    if (pthread_cond_init(&b.gate_cond, NULL) != 0) {
+        pthread_mutex_destroy(&b.gate_lock);
+        rw_destroy(&b.lock);
+        return -1;
+    }
+    for (; started < n; started++) {
+        w[started].b = &b;
+        if (pthread_create(&th[started], NULL, started < readers ? bench_reader : bench_writer, &w[started]) != 0) {
+            break;
+        }
+    }
+    if (started < n) {
+        // Let the threads that did start through, straight to the exit
+        atomic_store(&b.stop, 1);
+        rc = -1;
+    }
+    gate_release(&b);
+
+    long long t0 = now_ns();
+    if (rc == 0) {
+        struct timespec d = { ms / 1000, (ms % 1000) * 1000000L };
+        nanosleep(&d, NULL);
+        atomic_store(&b.stop, 1);
+    }
+    for (int i = 0; i < started; i++) pthread_join(th[i], NULL);
+    res->seconds = (now_ns() - t0) / 1e9;
+
+    if (rc == 0) {
+        long long total = 0, k = 0;
+        double sum = 0;
+        for (int i = 0; i < n; i++) {
+            if (i < readers) res->reads += w[i].ops;
+            else res->writes += w[i].ops;
+            res->torn += w[i].torn;
+            total += w[i].num_waits;
+        }
+        long long *waits = malloc((total ? total : 1) * sizeof *waits);
+        if (!waits) rc = -1;
+        for (int i = readers; i < n && waits; i++) {
+            for (long long j = 0; j < w[i].num_waits; j++) {
+                waits[k++] = w[i].waits[j];
+                sum += w[i].waits[j];
+            }
+        }
+        if (waits && total > 0) {
+            qsort(waits, total, sizeof *waits, cmp_ll);
+            res->wait_mean_ns = sum / total;
+            res->wait_p99_ns = waits[(total - 1) * 99 / 100];
+            res->wait_max_ns = waits[total - 1];
+        }
+        free(waits);
+    }
+    for (int i = 0; i < n; i++) free(w[i].waits);
+    pthread_cond_destroy(&b.gate_cond);
+    pthread_mutex_destroy(&b.gate_lock);
+    rw_destroy(&b.lock);
+    return rc;
+}
+
+static void batch_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s -b [-l LOCKS] [-r MIXES] [-d MS]\n"
+            "  -b         benchmark: readers and writers without the sleeps\n"
+            "  -l LOCKS   comma-separated list: reader, writer, fair, pthread (default: all)\n"
+            "  -r MIXES   comma-separated READERS:WRITERS thread counts, one run each,\n"
+            "             up to %d each (default 8:1,4:1,2:2,1:4)\n"
+            "  -d MS      length of each run in milliseconds (default 1000)\n",
+            prog, RW_MAX_THREADS);
+}
+
+// Parse "reader,fair" into policies; returns how many, or -1
+static int parse_lock_list(const char *list, const RwPolicy *pols[]) {
+    int n = 0;
+    char name[32];
+    while (*list) {
+        size_t len = strcspn(list, ",");
+        if (len == 0 || len >= sizeof name || n == RW_MAX_BATCH_LOCKS) {
+            fprintf(stderr, "Invalid lock list\n");
+            return -1;
+        }
+        memcpy(name, list, len);
+        name[len] = '\0';
+        if (!(pols[n++] = rw_policy_by_name(name))) return -1;
+        list += len;
+        if (*list == ',') list++;
+    }
+    return n;
+}
+
+// Parse "8:1,1:4" into reader and writer counts; returns how many, or -1
+static int parse_mix_list(const char *list, int readers[], int writers[]) {
+    int n = 0;
+    while (*list) {
+        char *end;
+        long r = strtol(list, &end, 10), w = -1;
+        if (*end == ':') w = strtol(end + 1, &end, 10);
+        if (end == list || (*end && *end != ',') || r < 0 || w < 0 || r + w == 0 || r > RW_MAX_THREADS ||
+            w > RW_MAX_THREADS || n == RW_MAX_MIXES) {
+            fprintf(stderr, "Invalid mix list \"%s\" (READERS:WRITERS, 0..%d, at most %d runs)\n", list,
+                    RW_MAX_THREADS, RW_MAX_MIXES);
+            return -1;
+        }
+        readers[n] = (int)r;
+        writers[n++] = (int)w;
+        list = *end ? end + 1 : end;
+    }
+    return n;
+}
+
+int rw_batch_main(int argc, char *argv[]) {
+    const RwPolicy *pols[RW_MAX_BATCH_LOCKS];
+    int num_pols = RW_NUM_POLICIES;
+    int readers[RW_MAX_MIXES] = { 8, 4, 2, 1 }, writers[RW_MAX_MIXES] = { 1, 1, 2, 4 }, num_mixes = 4;
+    int ms = 1000, bench = 0;
+    int opt;
+
+    for (int i = 0; i < RW_NUM_POLICIES; i++) pols[i] = RW_POLICIES[i];
+    while ((opt = getopt(argc, argv, "bl:r:d:h")) != -1) {
+        switch (opt) {
+            case 'b': bench = 1; break;
+            case 'l':
+                if ((num_pols = parse_lock_list(optarg, pols)) <= 0) return 1;
+                break;
+            case 'r':
+                if ((num_mixes = parse_mix_list(optarg, readers, writers)) <= 0) return 1;
+                break;
+            case 'd':
+                ms = atoi(optarg);
+                if (ms <= 0 || ms > 3600000) {
+                    fprintf(stderr, "Invalid run length \"%s\"\n", optarg);
+                    return 1;
+                }
+                break;
+            default:
+                batch_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (!bench || optind != argc) {
+        batch_usage(argv[0]);
+        return 1;
+    }
+
+    printf("\n--- Readers-Writers Benchmark (%d ms per run) ---\n", ms);
+    printf("+-------------------+---------+-------------+-------------+------------+------------+------------+\n");
+    printf("| Lock              | R:W     | Reads/s     | Writes/s    | Wait mean  | Wait p99   | Wait max   |\n");
+    printf("+-------------------+---------+-------------+-------------+------------+------------+------------+\n");
+    for (int m = 0; m < num_mixes; m++) {
+        for (int p = 0; p < num_pols; p++) {
+            RwBenchResult res;
+            char mix[24];
+            if (bench_run(pols[p], readers[m], writers[m], ms, &res) != 0) {
+                fprintf(stderr, "Could not run %s with %d:%d threads.\n", pols[p]->title, readers[m], writers[m]);
+                return 1;
+            }
+            snprintf(mix, sizeof mix, "%d:%d", readers[m], writers[m]);
+            printf("| %-17s | %-7s | %11.0f | %11.0f | %10.0f | %10lld | %10lld |\n", pols[p]->title, mix,
+                   res.reads / res.seconds, res.writes / res.seconds, res.wait_mean_ns, res.wait_p99_ns,
+                   res.wait_max_ns);
+            if (res.torn) printf("  (%lld reads saw a write half done!)\n", res.torn);
+            fflush(stdout);
+        }
+    }
+    printf("+-------------------+---------+-------------+-------------+------------+------------+------------+\n");
+    printf("Waits are in ns, from a writer asking for the lock to holding it. A writer\n"
+           "still waiting when the run ends is counted once the readers have stopped.\n");
+    return 0;
+}
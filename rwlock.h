@@ -0,0 +1,54 @@
+// rwlock.h — readers-writers locks used by 4.4.c
+//
+// The reader-priority solution of 4.4.c, a writer-preferring lock, a
+// phase-fair ticket lock and pthread_rwlock_t behind one interface, and a
+// benchmark driver that times them without the demo's sleeps.
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+#include <pthread.h>
+
+typedef struct RwPolicy RwPolicy;
+
+typedef struct {
+    const RwPolicy *pol;
+    void *state;         // Owned by the policy
+} RwLock;
+
+struct RwPolicy {
+    const char *name;    // Short name (used on command lines)
+    const char *title;   // Name in tables
+    int  (*init)(RwLock *l); // Allocate 'state'; 0 on success
+    void (*destroy)(RwLock *l);
+    void (*read_lock)(RwLock *l);
+    void (*read_unlock)(RwLock *l);
+    void (*write_lock)(RwLock *l);
+    void (*write_unlock)(RwLock *l);
+};
+
+// Readers get in whenever another reader is inside: writers can starve
+extern const RwPolicy RW_READER_PRIORITY;
+// New readers wait while a writer is waiting: readers can starve
+extern const RwPolicy RW_WRITER_PRIORITY;
+// Readers and writers alternate in phases, writers in ticket order: neither
+// starves, and a reader waits for at most one writer
+extern const RwPolicy RW_PHASE_FAIR;
+// The C library's pthread_rwlock_t with its default attributes
+extern const RwPolicy RW_PTHREAD;
+
+// All built-in policies, in table order
+extern const RwPolicy *const RW_POLICIES[];
+extern const int RW_NUM_POLICIES;
+
+// NULL (and a message) if there is no such policy
+const RwPolicy *rw_policy_by_name(const char *name);
+
+int  rw_init(RwLock *l, const RwPolicy *pol); // 0 on success, -1 on failure
+void rw_destroy(RwLock *l);
+
+// --- Benchmark ---
+// Non-interactive entry point used when 4.4 is started with arguments
+// other than "-l NAME"
+int rw_batch_main(int argc, char *argv[]);
+
+#endif
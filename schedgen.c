@@ -0,0 +1,222 @@
+// Build: gcc schedgen.c -lm -o schedgen
+//
+// Synthetic workload generator for the scheduling simulators (3.1.c-3.3.c).
+// Writes a reproducible trace in the format their batch mode reads (-f):
+// Poisson arrivals, and exponential, Pareto or bimodal burst times.
+// Records are streamed out one at a time, so any size fits in constant memory.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h> // getopt
+#include <sys/stat.h>
+#include "scheduler.h"
+
+enum { DIST_EXP, DIST_PARETO, DIST_BIMODAL };
+
+typedef struct {
+    long long jobs;
+    uint64_t seed;
+    double interarrival; // Mean time between arrivals
+    int dist;            // DIST_*
+    double mean;         // Exponential mean burst
+    double alpha;        // Pareto shape
+    double xmin;         // Pareto scale (smallest burst)
+    double short_mean;   // Bimodal: mean of the short jobs...
+    double long_mean;    // ...and of the long ones
+    double long_frac;    // Bimodal: fraction of long jobs
+    int prios;           // Priorities drawn from 0..prios-1 (0 = all 0)
+    int binary;
+} GenParams;
+
+// --- Random numbers: xoshiro256** seeded through splitmix64 ---
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static void rng_seed(Rng *g, uint64_t seed) {
+    for (int i = 0; i < 4; i++) g->s[i] = splitmix64(&seed);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t rng_next(Rng *g) {
+    uint64_t *s = g->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// Uniform in (0, 1]
+static double rng_unit(Rng *g) {
+    return ((rng_next(g) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static double rng_exp(Rng *g, double mean) {
+    return -mean * log(rng_unit(g));
+}
+
+// --- Burst times ---
+static int draw_burst(Rng *g, const GenParams *gp) {
+    double b;
+    switch (gp->dist) {
+        case DIST_PARETO:
+            b = gp->xmin / pow(rng_unit(g), 1.0 / gp->alpha);
+            break;
+        case DIST_BIMODAL:
+            b = rng_exp(g, rng_unit(g) <= gp->long_frac ? gp->long_mean : gp->short_mean);
+            break;
+        default:
+            b = rng_exp(g, gp->mean);
+            break;
+    }
+    // Bursts are whole, positive time units that fit the trace's int32
+    if (b < 1) return 1;
+    if (b > INT32_MAX) return INT32_MAX;
+    return (int)ceil(b);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s -n JOBS [-s SEED] [-i MEAN] [-d DIST] [-m MEAN] [-a ALPHA] [-x MIN]\n"
+            "          [-S MEAN] [-L MEAN] [-l FRACTION] [-P LEVELS] [-B] [-o OUT]\n"
+            "  -n JOBS      number of processes to generate\n"
+            "  -s SEED      random seed (default 1); the same seed gives the same trace\n"
+            "  -i MEAN      mean time between (Poisson) arrivals (default 10)\n"
+            "  -d DIST      burst distribution: exp, pareto or bimodal (default exp)\n"
+            "  -m MEAN      exp: mean burst (default 8)\n"
+            "  -a ALPHA     pareto: shape (default 1.5)\n"
+            "  -x MIN       pareto: smallest burst (default 2)\n"
+            "  -S MEAN      bimodal: mean burst of the short jobs (default 4)\n"
+            "  -L MEAN      bimodal: mean burst of the long jobs (default 100)\n"
+            "  -l FRACTION  bimodal: fraction of long jobs (default 0.1)\n"
+            "  -P LEVELS    priorities drawn uniformly from 0..LEVELS-1 (default 0 = none)\n"
+            "  -B           write the binary trace format instead of text\n"
+            "  -o OUT       write to OUT instead of stdout\n",
+            prog);
+}
+
+// Parse a positive number; returns 0 on success
+static int parse_positive(const char *s, double *v) {
+    char *end;
+    *v = strtod(s, &end);
+    return (end == s || *end || !(*v > 0)) ? -1 : 0;
+}
+
+static int generate(FILE *out, const GenParams *gp) {
+    Rng g;
+    double at = 0;
+
+    rng_seed(&g, gp->seed);
+    if (gp->binary) {
+        SchedTraceHeader h = { SCHED_TRACE_MAGIC, 3, (uint64_t)gp->jobs };
+        fwrite(&h, sizeof h, 1, out);
+    } else {
+        fprintf(out, "# schedgen -n %lld -s %llu: AT BT PRIO\n", gp->jobs, (unsigned long long)gp->seed);
+    }
+
+    for (long long i = 0; i < gp->jobs; i++) {
+        int32_t rec[3];
+        if (i > 0) at += rng_exp(&g, gp->interarrival);
+        if (at > INT32_MAX) {
+            fprintf(stderr, "Arrival times overflow after %lld jobs; lower the mean interarrival (-i).\n", i);
+            return -1;
+        }
+        rec[0] = (int32_t)at;
+        rec[1] = draw_burst(&g, gp);
+        rec[2] = gp->prios > 0 ? (int32_t)(rng_next(&g) % gp->prios) : 0;
+        if (gp->binary) {
+            fwrite(rec, sizeof rec, 1, out);
+        } else {
+            fprintf(out, "%d %d %d\n", rec[0], rec[1], rec[2]);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    GenParams gp = { 0, 1, 10, DIST_EXP, 8, 1.5, 2, 4, 100, 0.1, 0, 0 };
+    const char *out_path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:i:d:m:a:x:S:L:l:P:Bo:h")) != -1) {
+        int bad = 0;
+        switch (opt) {
+            case 'n': gp.jobs = atoll(optarg); bad = gp.jobs <= 0 || gp.jobs > INT32_MAX; break;
+            case 's': gp.seed = strtoull(optarg, NULL, 0); break;
+            case 'i': bad = parse_positive(optarg, &gp.interarrival); break;
+            case 'm': bad = parse_positive(optarg, &gp.mean); break;
+            case 'a': bad = parse_positive(optarg, &gp.alpha); break;
+            case 'x': bad = parse_positive(optarg, &gp.xmin); break;
+            case 'S': bad = parse_positive(optarg, &gp.short_mean); break;
+            case 'L': bad = parse_positive(optarg, &gp.long_mean); break;
+            case 'l': bad = parse_positive(optarg, &gp.long_frac) || gp.long_frac > 1; break;
+            case 'P': gp.prios = atoi(optarg); bad = gp.prios < 0; break;
+            case 'B': gp.binary = 1; break;
+            case 'o': out_path = optarg; break;
+            case 'd':
+                if (strcmp(optarg, "exp") == 0) {
+                    gp.dist = DIST_EXP;
+                } else if (strcmp(optarg, "pareto") == 0) {
+                    gp.dist = DIST_PARETO;
+                } else if (strcmp(optarg, "bimodal") == 0) {
+                    gp.dist = DIST_BIMODAL;
+                } else {
+                    bad = 1;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+        if (bad) {
+            fprintf(stderr, "Invalid value \"%s\" for -%c\n", optarg, opt);
+            return 1;
+        }
+    }
+    if (gp.jobs <= 0 || optind != argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *out = out_path ? fopen(out_path, gp.binary ? "wb" : "w") : stdout;
+    if (!out) {
+        perror(out_path);
+        return 1;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+    int rc = generate(out, &gp) == 0 ? 0 : 1;
+    if (fflush(out) != 0 || ferror(out)) {
+        perror(out_path ? out_path : "stdout");
+        rc = 1;
+    }
+    if (out != stdout) {
+        struct stat st;
+        int regular = fstat(fileno(out), &st) == 0 && S_ISREG(st.st_mode);
+        if (fclose(out) != 0 && rc == 0) {
+            perror(out_path);
+            rc = 1;
+        }
+        // A cut-short file would still load as a (shorter) valid trace; leave
+        // devices and pipes (-o /dev/stdout) alone
+        if (rc != 0 && regular) remove(out_path);
+    }
+    return rc;
+}
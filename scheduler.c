@@ -0,0 +1,1828 @@
+// scheduler.c — event-driven CPU scheduling engine and built-in policies
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>   // offsetof
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>    // open
+#include <unistd.h>   // close, getopt
+#include <sys/mman.h> // mmap, madvise
+#include <sys/stat.h> // fstat
+#include <pthread.h>
+#include <time.h>     // clock_gettime
+#include "scheduler.h"
+
+// ===================================================================
+// Trace handling
+// ===================================================================
+
+int sched_trace_init(SchedTrace *tr, int cap) {
+    if (cap < 16) cap = 16;
+    tr->p = malloc(cap * sizeof *tr->p);
+    tr->order = NULL;
+    tr->n = 0;
+    tr->cap = cap;
+    return tr->p ? 0 : -1;
+}
+
+// Append one process (amortized O(1); the array doubles when full)
+int sched_trace_add(SchedTrace *tr, int at, int bt, int prio) {
+    if (tr->n == tr->cap) {
+        int cap = tr->cap * 2;
+        P *p = realloc(tr->p, cap * sizeof *p);
+        if (!p) return -1;
+        tr->p = p;
+        tr->cap = cap;
+    }
+    P *q = &tr->p[tr->n];
+    q->id = tr->n;
+    q->at = at;
+    q->bt = bt;
+    q->prio = prio;
+    tr->n++;
+    return 0;
+}
+
+// Arrival-order entry used only while sorting
+typedef struct {
+    int at;
+    int idx;
+} Arrival;
+
+static int cmp_arrival(const void *x, const void *y) {
+    const Arrival *p = x, *q = y;
+    if (p->at != q->at) return (p->at < q->at) ? -1 : 1;
+    return (p->idx < q->idx) ? -1 : (p->idx > q->idx);
+}
+
+// The single sort pass: every policy admits processes in this order
+int sched_trace_sort(SchedTrace *tr) {
+    Arrival *arr = malloc((tr->n ? tr->n : 1) * sizeof *arr);
+    int *order = realloc(tr->order, (tr->n ? tr->n : 1) * sizeof *order);
+    if (!arr || !order) {
+        free(arr);
+        if (order) tr->order = order;
+        return -1;
+    }
+    for (int i = 0; i < tr->n; i++) {
+        arr[i].at = tr->p[i].at;
+        arr[i].idx = i;
+    }
+    qsort(arr, tr->n, sizeof *arr, cmp_arrival);
+    for (int i = 0; i < tr->n; i++) {
+        order[i] = arr[i].idx;
+    }
+    free(arr);
+    tr->order = order;
+    return 0;
+}
+
+void sched_trace_free(SchedTrace *tr) {
+    free(tr->p);
+    free(tr->order);
+    tr->p = NULL;
+    tr->order = NULL;
+    tr->n = tr->cap = 0;
+}
+
+int sched_read_processes(SchedTrace *tr) {
+    int n;
+    printf("Enter the number of processes (n): ");
+    if (scanf("%d", &n) != 1 || n <= 0) {
+        printf("Invalid number of processes.\n");
+        return 1;
+    }
+    if (sched_trace_init(tr, n) != 0) {
+        printf("Memory allocation failed.\n");
+        return 1;
+    }
+
+    printf("Enter Arrival Time (AT) and Burst Time (BT) for each process:\n");
+    for (int i = 0; i < n; i++) {
+        int at, bt;
+        printf("P%d (AT BT): ", i);
+        if (scanf("%d %d", &at, &bt) != 2 || bt <= 0) {
+            printf("Invalid time input. Burst Time must be positive.\n");
+            sched_trace_free(tr);
+            return 1;
+        }
+        sched_trace_add(tr, at, bt, 0);
+    }
+
+    if (sched_trace_sort(tr) != 0) {
+        printf("Memory allocation failed.\n");
+        sched_trace_free(tr);
+        return 1;
+    }
+    return 0;
+}
+
+// ===================================================================
+// Trace files
+// ===================================================================
+
+// Text traces are parsed line by line, so memory only grows with the trace
+// itself (in sched_trace_add), never with a read buffer.
+static int load_text_trace(SchedTrace *tr, FILE *fp, const char *path) {
+    char line[256];
+    long lineno = 0;
+
+    while (fgets(line, sizeof line, fp)) {
+        char *s = line, *end;
+        lineno++;
+
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '#' || *s == '\n' || *s == '\r' || *s == '\0') continue; // Comment or blank
+
+        long at = strtol(s, &end, 10);
+        if (end == s) goto bad;
+        s = end;
+        long bt = strtol(s, &end, 10);
+        if (end == s || bt <= 0 || at < 0 || at > INT32_MAX || bt > INT32_MAX) goto bad;
+        s = end;
+        long prio = strtol(s, &end, 10); // Optional third column
+        if (end == s) prio = 0;
+        if (prio < INT32_MIN || prio > INT32_MAX) goto bad;
+
+        if (sched_trace_add(tr, (int)at, (int)bt, (int)prio) != 0) {
+            fprintf(stderr, "%s: out of memory after %d processes\n", path, tr->n);
+            return -1;
+        }
+        continue;
+    bad:
+        fprintf(stderr, "%s:%ld: expected \"AT BT [PRIO]\" with AT >= 0 and BT > 0\n", path, lineno);
+        return -1;
+    }
+    return 0;
+}
+
+// Binary traces are mapped read-only and copied sequentially into the heap
+// trace; MADV_SEQUENTIAL lets the kernel read ahead and drop used pages.
+static int load_binary_trace(SchedTrace *tr, int fd, const char *path) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        return -1;
+    }
+
+    size_t size = st.st_size;
+    const unsigned char *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    madvise((void *)map, size, MADV_SEQUENTIAL);
+
+    SchedTraceHeader h = { { 0 }, 0, 0 };
+    if (size >= sizeof h) memcpy(&h, map, sizeof h);
+    if (h.fields < 2 || h.fields > 64 || h.count > INT32_MAX
+        || sizeof h + h.count * h.fields * sizeof(int32_t) > size) {
+        fprintf(stderr, "%s: truncated or corrupt binary trace\n", path);
+        munmap((void *)map, size);
+        return -1;
+    }
+
+    int rc = 0;
+    const unsigned char *rec = map + sizeof h;
+    for (uint64_t i = 0; i < h.count; i++, rec += h.fields * sizeof(int32_t)) {
+        int32_t f[3] = { 0, 0, 0 };
+        memcpy(f, rec, (h.fields < 3 ? 2 : 3) * sizeof(int32_t));
+        if (f[0] < 0 || f[1] <= 0) {
+            fprintf(stderr, "%s: record %llu has AT < 0 or BT <= 0\n", path, (unsigned long long)i);
+            rc = -1;
+            break;
+        }
+        if (sched_trace_add(tr, f[0], f[1], f[2]) != 0) {
+            fprintf(stderr, "%s: out of memory after %d processes\n", path, tr->n);
+            rc = -1;
+            break;
+        }
+    }
+
+    munmap((void *)map, size);
+    return rc;
+}
+
+int sched_trace_load(SchedTrace *tr, const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    char magic[4] = { 0 };
+    ssize_t got = read(fd, magic, sizeof magic);
+
+    if (sched_trace_init(tr, 1024) != 0) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        close(fd);
+        return -1;
+    }
+
+    int rc;
+    if (got == sizeof magic && memcmp(magic, SCHED_TRACE_MAGIC, sizeof magic) == 0) {
+        rc = load_binary_trace(tr, fd, path);
+        close(fd);
+    } else {
+        FILE *fp = fdopen(fd, "r");
+        if (!fp) {
+            perror(path);
+            close(fd);
+            sched_trace_free(tr);
+            return -1;
+        }
+        rewind(fp);
+        setvbuf(fp, NULL, _IOFBF, 1 << 20);
+        rc = load_text_trace(tr, fp, path);
+        fclose(fp);
+    }
+
+    if (rc == 0 && tr->n == 0) {
+        fprintf(stderr, "%s: trace contains no processes\n", path);
+        rc = -1;
+    }
+    if (rc == 0 && sched_trace_sort(tr) != 0) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        rc = -1;
+    }
+    if (rc != 0) sched_trace_free(tr);
+    return rc;
+}
+
+int sched_trace_write_binary(const SchedTrace *tr, const char *path) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    setvbuf(fp, NULL, _IOFBF, 1 << 20);
+
+    SchedTraceHeader h;
+    memcpy(h.magic, SCHED_TRACE_MAGIC, sizeof h.magic);
+    h.fields = 3;
+    h.count = tr->n;
+    int rc = fwrite(&h, sizeof h, 1, fp) == 1 ? 0 : -1;
+
+    for (int i = 0; i < tr->n && rc == 0; i++) {
+        int32_t f[3] = { tr->p[i].at, tr->p[i].bt, tr->p[i].prio };
+        if (fwrite(f, sizeof f, 1, fp) != 1) rc = -1;
+    }
+
+    // A short write (e.g. a full disk) may only show up in ferror() or fclose()
+    if (ferror(fp)) rc = -1;
+    if (fclose(fp) != 0) rc = -1;
+    if (rc != 0) perror(path);
+    return rc;
+}
+
+// ===================================================================
+// Ready-queue building blocks
+// ===================================================================
+
+// Queues grow on demand, so a policy instance per CPU run queue costs memory
+// proportional to what it actually holds rather than to the whole trace.
+static void *grow(void *p, size_t size) {
+    void *q = realloc(p, size);
+    if (!q) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(1);
+    }
+    return q;
+}
+
+// --- FIFO ring buffer of process indices ---
+typedef struct {
+    int *slot;
+    int cap;
+    int head;  // Index of the next process to dispatch
+    int count; // Number of queued processes
+} Fifo;
+
+static int fifo_init(Fifo *q) {
+    q->cap = 16;
+    q->slot = malloc(q->cap * sizeof *q->slot);
+    q->head = q->count = 0;
+    return q->slot ? 0 : -1;
+}
+
+static void fifo_reserve(Fifo *q) {
+    if (q->count == q->cap) {
+        // Double the ring and unwrap it so the queued order is preserved
+        q->slot = grow(q->slot, 2 * q->cap * sizeof *q->slot);
+        memcpy(q->slot + q->cap, q->slot, q->head * sizeof *q->slot);
+        q->cap *= 2;
+    }
+}
+
+static void fifo_push(Fifo *q, int k) {
+    fifo_reserve(q);
+    int tail = q->head + q->count;
+    if (tail >= q->cap) tail -= q->cap;
+    q->slot[tail] = k;
+    q->count++;
+}
+
+// Queue k to be dispatched next
+static void fifo_push_front(Fifo *q, int k) {
+    fifo_reserve(q);
+    if (--q->head < 0) q->head = q->cap - 1;
+    q->slot[q->head] = k;
+    q->count++;
+}
+
+static int fifo_pop(Fifo *q) {
+    if (q->count == 0) return -1;
+    int k = q->slot[q->head];
+    if (++q->head == q->cap) q->head = 0;
+    q->count--;
+    return k;
+}
+
+// --- Binary min-heap of process indices ordered by key[k] ---
+// Ties go to the lower index, i.e. the process a linear scan over the
+// input (keeping the first minimum) would pick.
+typedef struct {
+    int *v;
+    int size;
+    int cap;
+    const long long *key; // The run's per-process keys; key[k] must not change while k is queued
+} Heap;
+
+static int heap_init(Heap *h, const long long *key) {
+    h->cap = 16;
+    h->v = malloc(h->cap * sizeof *h->v);
+    h->size = 0;
+    h->key = key;
+    return h->v ? 0 : -1;
+}
+
+static int heap_before(const Heap *h, int x, int y) {
+    if (h->key[x] != h->key[y]) return h->key[x] < h->key[y];
+    return x < y;
+}
+
+static void heap_push(Heap *h, int k) {
+    if (h->size == h->cap) {
+        h->cap *= 2;
+        h->v = grow(h->v, h->cap * sizeof *h->v);
+    }
+    int i = h->size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!heap_before(h, k, h->v[parent])) break;
+        h->v[i] = h->v[parent];
+        i = parent;
+    }
+    h->v[i] = k;
+}
+
+static int heap_pop(Heap *h) {
+    if (h->size == 0) return -1;
+    int top = h->v[0];
+    int last = h->v[--h->size];
+    int i = 0;
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= h->size) break;
+        if (child + 1 < h->size && heap_before(h, h->v[child + 1], h->v[child])) child++;
+        if (!heap_before(h, h->v[child], last)) break;
+        h->v[i] = h->v[child];
+        i = child;
+    }
+    if (h->size > 0) h->v[i] = last;
+    return top;
+}
+
+// ===================================================================
+// Built-in policies
+// ===================================================================
+
+// --- FCFS and RR: a plain FIFO; RR just bounds the slice ---
+static int fifo_policy_init(SchedRun *r) {
+    Fifo *q = malloc(sizeof *q);
+    if (!q || fifo_init(q) != 0) {
+        free(q);
+        return -1;
+    }
+    r->state = q;
+    return 0;
+}
+
+static void fifo_policy_destroy(SchedRun *r) {
+    Fifo *q = r->state;
+    free(q->slot);
+    free(q);
+}
+
+static void fifo_policy_enqueue(SchedRun *r, int k) {
+    fifo_push(r->state, k);
+}
+
+static void fifo_policy_requeue(SchedRun *r, int k, int ran) {
+    (void)ran;
+    fifo_push(r->state, k);
+}
+
+static int fifo_policy_select(SchedRun *r) {
+    return fifo_pop(r->state);
+}
+
+static int run_to_completion(SchedRun *r, int k) {
+    (void)r;
+    (void)k;
+    return 0;
+}
+
+static int rr_slice(SchedRun *r, int k) {
+    (void)k;
+    return r->prm.quantum;
+}
+
+// --- SJF and SRTF: a min-heap keyed on burst / remaining time ---
+static int heap_policy_init(SchedRun *r) {
+    Heap *h = malloc(sizeof *h);
+    if (!h || heap_init(h, r->key) != 0) {
+        free(h);
+        return -1;
+    }
+    r->state = h;
+    return 0;
+}
+
+static void heap_policy_destroy(SchedRun *r) {
+    Heap *h = r->state;
+    free(h->v);
+    free(h);
+}
+
+static int heap_policy_select(SchedRun *r) {
+    return heap_pop(r->state);
+}
+
+// SJF never preempts, but a re-queued process keeps its burst-time key
+static void heap_policy_requeue(SchedRun *r, int k, int ran) {
+    (void)ran;
+    heap_push(r->state, k);
+}
+
+static void sjf_enqueue(SchedRun *r, int k) {
+    r->key[k] = r->tr->p[k].bt;
+    heap_push(r->state, k);
+}
+
+// Keyed on the current remaining time; only the running process's 'rt'
+// changes, and it is re-keyed here before going back into the heap.
+static void srtf_enqueue(SchedRun *r, int k) {
+    r->key[k] = r->rt[k];
+    heap_push(r->state, k);
+}
+
+static void srtf_requeue(SchedRun *r, int k, int ran) {
+    (void)ran;
+    srtf_enqueue(r, k);
+}
+
+// --- Priority (preemptive) with aging ---
+// Lower 'prio' values run first. With aging, every 'prio_aging' time units
+// spent waiting are worth one priority level. Since all waiting processes age
+// at the same rate, comparing  prio - (t - ready_since) / aging  reduces to
+// comparing the time-independent key  prio * aging + ready_since,  so the
+// heap never needs re-ordering as time passes.
+static void prio_enqueue(SchedRun *r, int k) {
+    int aging = r->prm.prio_aging;
+    long long prio = r->tr->p[k].prio;
+    r->key[k] = aging > 0 ? prio * aging + r->t : prio;
+    heap_push(r->state, k);
+}
+
+// A preempted process starts waiting (and aging) again from now
+static void prio_requeue(SchedRun *r, int k, int ran) {
+    (void)ran;
+    prio_enqueue(r, k);
+}
+
+// --- MLFQ (Multi-Level Feedback Queue) ---
+// New processes enter the top level (0). A process that uses up its level's
+// quantum drops one level; one preempted earlier by an arrival keeps its level
+// and the unused part of its quantum, and resumes first. Every 'mlfq_boost'
+// time units all processes move back to the top level so that long jobs are
+// not starved. The level and the time used at that level are packed into the
+// run's per-process key.
+typedef struct {
+    Fifo level[SCHED_MLFQ_MAX_LEVELS];
+    long long epoch;      // Boost periods elapsed when last checked
+    long long boosted_at; // Time of the most recent boost
+} Mlfq;
+
+#define MLFQ_KEY(level, used) (((long long)(level) << 32) | (unsigned)(used))
+#define MLFQ_LEVEL(key)       ((int)((key) >> 32))
+#define MLFQ_USED(key)        ((int)((key) & 0xffffffffLL))
+
+static int mlfq_init(SchedRun *r) {
+    Mlfq *m = calloc(1, sizeof *m);
+    if (!m) return -1;
+    for (int l = 0; l < r->prm.mlfq_levels; l++) {
+        if (fifo_init(&m->level[l]) != 0) {
+            while (l-- > 0) free(m->level[l].slot);
+            free(m);
+            return -1;
+        }
+    }
+    r->state = m;
+    return 0;
+}
+
+static void mlfq_destroy(SchedRun *r) {
+    Mlfq *m = r->state;
+    for (int l = 0; l < r->prm.mlfq_levels; l++) free(m->level[l].slot);
+    free(m);
+}
+
+// Apply a pending boost lazily, the first time the policy is consulted after it
+static void mlfq_boost(SchedRun *r) {
+    Mlfq *m = r->state;
+    if (r->prm.mlfq_boost <= 0) return;
+    long long epoch = r->t / r->prm.mlfq_boost;
+    if (epoch == m->epoch) return;
+
+    m->epoch = epoch;
+    m->boosted_at = epoch * r->prm.mlfq_boost;
+    for (int l = 1; l < r->prm.mlfq_levels; l++) {
+        int k;
+        while ((k = fifo_pop(&m->level[l])) >= 0) {
+            r->key[k] = MLFQ_KEY(0, 0);
+            fifo_push(&m->level[0], k);
+        }
+    }
+}
+
+static void mlfq_enqueue(SchedRun *r, int k) {
+    Mlfq *m = r->state;
+    mlfq_boost(r);
+    r->key[k] = MLFQ_KEY(0, 0);
+    fifo_push(&m->level[0], k);
+}
+
+static void mlfq_requeue(SchedRun *r, int k, int ran) {
+    Mlfq *m = r->state;
+    int level = MLFQ_LEVEL(r->key[k]);
+    int used = MLFQ_USED(r->key[k]) + ran;
+
+    mlfq_boost(r);
+    if (r->t - ran < m->boosted_at) {
+        // It was running when the boost happened
+        r->key[k] = MLFQ_KEY(0, 0);
+        fifo_push(&m->level[0], k);
+    } else if (used >= r->prm.mlfq_quantum[level]) {
+        // Quantum used up: demote (the bottom level is plain RR)
+        if (level < r->prm.mlfq_levels - 1) level++;
+        r->key[k] = MLFQ_KEY(level, 0);
+        fifo_push(&m->level[level], k);
+    } else {
+        r->key[k] = MLFQ_KEY(level, used);
+        fifo_push_front(&m->level[level], k);
+    }
+}
+
+static int mlfq_select(SchedRun *r) {
+    Mlfq *m = r->state;
+    mlfq_boost(r);
+    for (int l = 0; l < r->prm.mlfq_levels; l++) {
+        int k = fifo_pop(&m->level[l]);
+        if (k >= 0) return k;
+    }
+    return -1;
+}
+
+static int mlfq_slice(SchedRun *r, int k) {
+    return r->prm.mlfq_quantum[MLFQ_LEVEL(r->key[k])] - MLFQ_USED(r->key[k]);
+}
+
+const SchedPolicy SCHED_POLICY_FCFS = {
+    "fcfs", "FCFS (First-Come, First-Served)", 0, 0,
+    fifo_policy_init, fifo_policy_destroy, fifo_policy_enqueue,
+    fifo_policy_select, fifo_policy_requeue, run_to_completion
+};
+
+const SchedPolicy SCHED_POLICY_SJF = {
+    "sjf", "SJF (Shortest Job First) Non-Preemptive", 0, 0,
+    heap_policy_init, heap_policy_destroy, sjf_enqueue,
+    heap_policy_select, heap_policy_requeue, run_to_completion
+};
+
+const SchedPolicy SCHED_POLICY_SRTF = {
+    "srtf", "SJF Preemptive (SRTF - Shortest Remaining Time First)", 1, 0,
+    heap_policy_init, heap_policy_destroy, srtf_enqueue,
+    heap_policy_select, srtf_requeue, run_to_completion
+};
+
+const SchedPolicy SCHED_POLICY_RR = {
+    "rr", "Round Robin", 0, 1,
+    fifo_policy_init, fifo_policy_destroy, fifo_policy_enqueue,
+    fifo_policy_select, fifo_policy_requeue, rr_slice
+};
+
+const SchedPolicy SCHED_POLICY_PRIO = {
+    "prio", "Priority (Preemptive, with Aging)", 1, 0,
+    heap_policy_init, heap_policy_destroy, prio_enqueue,
+    heap_policy_select, prio_requeue, run_to_completion
+};
+
+const SchedPolicy SCHED_POLICY_MLFQ = {
+    "mlfq", "MLFQ (Multi-Level Feedback Queue)", 1, 0,
+    mlfq_init, mlfq_destroy, mlfq_enqueue,
+    mlfq_select, mlfq_requeue, mlfq_slice
+};
+
+const SchedPolicy *const SCHED_POLICIES[] = {
+    &SCHED_POLICY_FCFS, &SCHED_POLICY_SJF, &SCHED_POLICY_SRTF, &SCHED_POLICY_RR, &SCHED_POLICY_PRIO, &SCHED_POLICY_MLFQ
+};
+const int SCHED_NUM_POLICIES = sizeof SCHED_POLICIES / sizeof SCHED_POLICIES[0];
+
+void sched_params_init(SchedParams *prm) {
+    memset(prm, 0, sizeof *prm);
+    prm->quantum = 2;
+    prm->cpus = 1;
+    prm->balance = SCHED_BALANCE_GLOBAL;
+    prm->mlfq_levels = 3;
+    prm->mlfq_quantum[0] = 2;
+    prm->mlfq_quantum[1] = 4;
+    prm->mlfq_quantum[2] = 8;
+    prm->mlfq_boost = 100;
+}
+
+const SchedPolicy *sched_policy_by_name(const char *name) {
+    for (int i = 0; i < SCHED_NUM_POLICIES; i++) {
+        if (strcmp(SCHED_POLICIES[i]->name, name) == 0) return SCHED_POLICIES[i];
+    }
+    return NULL;
+}
+
+// ===================================================================
+// Timeline recorder
+// ===================================================================
+
+// Only the last segment of each CPU is kept in memory: a slice that continues
+// it (same process, no gap) just extends it, anything else writes it out.
+// Everything else goes straight to the (buffered) file, so memory stays
+// constant however long the trace is.
+struct SchedTimeline {
+    FILE *f;
+    int format;           // SCHED_TIMELINE_*
+    int run;              // Run number of the segments being recorded
+    int ncpu;
+    SchedSegment *open;   // Last segment per CPU, id -1 if none
+    long long segments;   // Segments written so far
+};
+
+SchedTimeline *sched_timeline_open(const char *path, int format) {
+    SchedTimeline *tl = calloc(1, sizeof *tl);
+    if (!tl) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return NULL;
+    }
+    tl->f = fopen(path, "wb");
+    if (!tl->f) {
+        perror(path);
+        free(tl);
+        return NULL;
+    }
+    setvbuf(tl->f, NULL, _IOFBF, 1 << 20);
+    tl->format = format;
+    tl->run = -1;
+
+    if (format == SCHED_TIMELINE_CHROME) {
+        fprintf(tl->f, "{\"traceEvents\": [");
+    } else {
+        // The count is filled in by sched_timeline_close()
+        SchedTimelineHeader h = { SCHED_TIMELINE_MAGIC, sizeof(SchedSegment), 0 };
+        fwrite(&h, sizeof h, 1, tl->f);
+    }
+    return tl;
+}
+
+static void timeline_write(SchedTimeline *tl, const SchedSegment *seg) {
+    if (tl->format == SCHED_TIMELINE_CHROME) {
+        fprintf(tl->f, ",\n{\"name\": \"P%d\", \"ph\": \"X\", \"pid\": %u, \"tid\": %u, \"ts\": %lld, \"dur\": %lld}",
+                seg->id, seg->run, seg->cpu, (long long)seg->start, (long long)(seg->end - seg->start));
+    } else {
+        fwrite(seg, sizeof *seg, 1, tl->f);
+    }
+    tl->segments++;
+}
+
+// Write out the segments still open at the end of a run
+static void timeline_flush(SchedTimeline *tl) {
+    for (int c = 0; c < tl->ncpu; c++) {
+        if (tl->open[c].id >= 0) timeline_write(tl, &tl->open[c]);
+        tl->open[c].id = -1;
+    }
+}
+
+void sched_timeline_begin(SchedTimeline *tl, const char *label, int cpus) {
+    if (cpus < 1) cpus = 1;
+    timeline_flush(tl);
+    tl->open = grow(tl->open, cpus * sizeof *tl->open);
+    tl->ncpu = cpus;
+    tl->run++;
+    for (int c = 0; c < cpus; c++) tl->open[c].id = -1;
+
+    if (tl->format == SCHED_TIMELINE_CHROME) {
+        // Each run shows up as one process in the viewer, with a thread per CPU
+        fprintf(tl->f, "%s\n{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, \"args\": {\"name\": \"%s\"}}",
+                tl->run > 0 ? "," : "", tl->run, label);
+        for (int c = 0; c < cpus; c++) {
+            fprintf(tl->f, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %d, \"args\": {\"name\": \"CPU %d\"}}",
+                    tl->run, c, c);
+        }
+    }
+}
+
+// Process k ran on 'cpu' during [start, end)
+static void timeline_add(SchedTimeline *tl, int cpu, int k, long long start, long long end) {
+    SchedSegment *seg = &tl->open[cpu];
+    if (seg->id == k && seg->end == start) {
+        seg->end = end;
+        return;
+    }
+    if (seg->id >= 0) timeline_write(tl, seg);
+    seg->start = start;
+    seg->end = end;
+    seg->id = k;
+    seg->cpu = (uint16_t)cpu;
+    seg->run = (uint16_t)tl->run;
+}
+
+int sched_timeline_close(SchedTimeline *tl) {
+    int rc = 0;
+
+    timeline_flush(tl);
+    if (tl->format == SCHED_TIMELINE_CHROME) {
+        fprintf(tl->f, "\n]}\n");
+    } else if (fseek(tl->f, offsetof(SchedTimelineHeader, count), SEEK_SET) == 0) {
+        uint64_t count = (uint64_t)tl->segments;
+        fwrite(&count, sizeof count, 1, tl->f);
+    }
+    if (ferror(tl->f)) rc = -1;
+    if (fclose(tl->f) != 0) rc = -1;
+    free(tl->open);
+    free(tl);
+    return rc;
+}
+
+// ===================================================================
+// The event loop
+// ===================================================================
+
+// Allocate the per-process arrays shared by every run queue of a run
+static int run_alloc(SchedRun *r, const SchedTrace *tr, const SchedPolicy *pol, const SchedParams *prm) {
+    int n = tr->n ? tr->n : 1;
+    int ncpu = prm->cpus > 1 ? prm->cpus : 1;
+
+    memset(r, 0, sizeof *r);
+    r->tr = tr;
+    r->pol = pol;
+    r->prm = *prm;
+    r->prm.cpus = ncpu;
+    r->rt = malloc(n * sizeof *r->rt);
+    r->ct = malloc(n * sizeof *r->ct);
+    r->st = malloc(n * sizeof *r->st);
+    r->key = malloc(n * sizeof *r->key);
+    r->cpu_busy = calloc(ncpu, sizeof *r->cpu_busy);
+    if (!r->rt || !r->ct || !r->st || !r->key || !r->cpu_busy) {
+        sched_run_free(r);
+        return -1;
+    }
+    for (int i = 0; i < tr->n; i++) {
+        r->rt[i] = tr->p[i].bt;
+        r->st[i] = -1;
+    }
+    return 0;
+}
+
+// Single CPU. Time only advances to the next event — a completion, the end of
+// a slice, or (for preempt_on_arrival policies) the next arrival — so the cost
+// depends on the number of scheduling decisions, never on the magnitude of
+// the times.
+static int run_uniprocessor(SchedRun *r) {
+    const SchedPolicy *pol = r->pol;
+    int n = r->tr->n;
+    const P *p = r->tr->p;
+    const int *order = r->tr->order;
+
+    if (pol->init(r) != 0) return -1;
+
+    int done = 0;  // Number of completed processes
+    int next = 0;  // Next entry of 'order' still waiting to arrive
+    int last = -1; // Process that held the CPU most recently
+    long long t = 0;
+
+    while (done < n) {
+        // Admit every process that has arrived by time t
+        r->t = t;
+        while (next < n && p[order[next]].at <= t) {
+            pol->on_arrival(r, order[next++]);
+        }
+
+        int k = pol->select_next(r);
+        if (k < 0) {
+            // CPU is idle: jump straight to the next arrival
+            t = p[order[next]].at;
+            continue;
+        }
+
+        if (last != -1 && last != k) {
+            t += r->prm.switch_cost;
+            r->switches++;
+
+            // Processes that arrived during the switch are queued right away
+            r->t = t;
+            while (next < n && p[order[next]].at <= t) {
+                pol->on_arrival(r, order[next++]);
+            }
+        }
+        last = k;
+        if (r->st[k] < 0) r->st[k] = t;
+
+        // Run until completion, the end of the slice, or a preempting arrival
+        int run = r->rt[k];
+        int slice = pol->time_slice(r, k);
+        if (slice > 0 && slice < run) run = slice;
+        if (pol->preempt_on_arrival && next < n && p[order[next]].at - t < run) {
+            run = (int)(p[order[next]].at - t);
+        }
+        r->rt[k] -= run;
+        r->busy += run;
+        if (r->timeline && run > 0) timeline_add(r->timeline, 0, k, t, t + run);
+        t += run;
+
+        // Arrivals during the slice are queued ahead of the preempted process
+        r->t = t;
+        while (next < n && p[order[next]].at <= t) {
+            pol->on_arrival(r, order[next++]);
+        }
+
+        if (r->rt[k] == 0) {
+            r->ct[k] = t;
+            done++;
+        } else {
+            pol->on_preempt(r, k, run);
+        }
+    }
+
+    r->t = t;
+    r->cpu_busy[0] = r->busy;
+    pol->destroy(r);
+    r->state = NULL;
+    return 0;
+}
+
+// --- SMP ---
+// Each run queue is an independent policy instance: a SchedRun that shares the
+// per-process arrays of the main run but has its own 'state', so policies need
+// no knowledge of CPUs. Events are found by scanning the CPUs, which is cheap
+// next to the O(log n) queue operations for realistic core counts.
+typedef struct {
+    int queue;       // Run queue this CPU dispatches from
+    int running;     // Process on this CPU, -1 if idle
+    int last;        // Process that ran here most recently (for the switch cost)
+    long long start; // When 'running' starts executing (after any switch cost)
+    long long end;   // When its slice ends
+} Cpu;
+
+typedef struct {
+    SchedRun *r;
+    SchedRun *rq;  // One policy instance per run queue
+    int *qlen;     // Processes waiting in each run queue
+    Cpu *cpu;
+    int ncpu;
+    int nq;
+    int *lastcpu;  // CPU each process last ran on, -1 if it has not run yet
+} Smp;
+
+static void smp_enqueue(Smp *s, int q, int k, int ran, int preempted) {
+    if (preempted) {
+        s->r->pol->on_preempt(&s->rq[q], k, ran);
+    } else {
+        s->r->pol->on_arrival(&s->rq[q], k);
+    }
+    s->qlen[q]++;
+}
+
+// Put process k on CPU c at time t
+static void smp_start(Smp *s, int c, int k, long long t) {
+    SchedRun *r = s->r;
+    Cpu *cpu = &s->cpu[c];
+
+    if (cpu->last != -1 && cpu->last != k) {
+        t += r->prm.switch_cost;
+        r->switches++;
+    }
+    if (s->lastcpu[k] != -1 && s->lastcpu[k] != c) {
+        r->migrations++;
+    }
+    s->lastcpu[k] = c;
+    cpu->last = k;
+    cpu->running = k;
+    cpu->start = t;
+    if (r->st[k] < 0) r->st[k] = t;
+
+    int run = r->rt[k];
+    int slice = r->pol->time_slice(&s->rq[cpu->queue], k);
+    if (slice > 0 && slice < run) run = slice;
+    cpu->end = t + run;
+}
+
+// Take the running process off CPU c at time t; returns how long it ran
+static int smp_stop(Smp *s, int c, long long t) {
+    Cpu *cpu = &s->cpu[c];
+    int k = cpu->running;
+    int ran = t > cpu->start ? (int)(t - cpu->start) : 0;
+
+    s->r->rt[k] -= ran;
+    s->r->busy += ran;
+    s->r->cpu_busy[c] += ran;
+    if (s->r->timeline && ran > 0) timeline_add(s->r->timeline, c, k, cpu->start, t);
+    cpu->running = -1;
+    return ran;
+}
+
+static int smp_pop(Smp *s, int q) {
+    int k = s->r->pol->select_next(&s->rq[q]);
+    if (k >= 0) s->qlen[q]--;
+    return k;
+}
+
+// Arrivals go to the least loaded CPU (queued + running), lowest index on ties
+static int smp_place(const Smp *s) {
+    if (s->nq == 1) return 0;
+    int best = 0, best_load = -1;
+    for (int q = 0; q < s->nq; q++) {
+        int load = s->qlen[q] + (s->cpu[q].running >= 0);
+        if (best_load < 0 || load < best_load) {
+            best = q;
+            best_load = load;
+        }
+    }
+    return best;
+}
+
+static void smp_dispatch(Smp *s, long long t) {
+    SchedRun *r = s->r;
+
+    if (s->nq == 1) {
+        // Global queue: pop one process per idle CPU, then hand each back to
+        // the CPU it last ran on when that CPU is free, to avoid needless
+        // migrations; the rest fill the remaining idle CPUs in order.
+        int picked[s->ncpu], npicked = 0;
+        for (int c = 0; c < s->ncpu; c++) {
+            if (s->cpu[c].running >= 0) continue;
+            int k = smp_pop(s, 0);
+            if (k < 0) break;
+            picked[npicked++] = k;
+        }
+        for (int i = 0; i < npicked; i++) {
+            int c = s->lastcpu[picked[i]];
+            if (c >= 0 && s->cpu[c].running < 0) {
+                smp_start(s, c, picked[i], t);
+                picked[i] = -1;
+            }
+        }
+        for (int i = 0, c = 0; i < npicked; i++) {
+            if (picked[i] < 0) continue;
+            while (s->cpu[c].running >= 0) c++;
+            smp_start(s, c, picked[i], t);
+        }
+        return;
+    }
+
+    for (int c = 0; c < s->ncpu; c++) {
+        if (s->cpu[c].running >= 0) continue;
+        int k = smp_pop(s, s->cpu[c].queue);
+        if (k >= 0) smp_start(s, c, k, t);
+    }
+    if (r->prm.balance != SCHED_BALANCE_STEAL) return;
+
+    // Only once every idle CPU has taken from its own queue: CPUs that are
+    // still idle steal from the longest queue, so a lower-numbered CPU never
+    // takes a process its owner was about to run
+    for (int c = 0; c < s->ncpu; c++) {
+        if (s->cpu[c].running >= 0) continue;
+        int victim = -1;
+        for (int q = 0; q < s->nq; q++) {
+            if (s->qlen[q] > 0 && (victim < 0 || s->qlen[q] > s->qlen[victim])) victim = q;
+        }
+        if (victim < 0) break;
+        smp_start(s, c, smp_pop(s, victim), t);
+        r->steals++;
+    }
+}
+
+static int run_smp(SchedRun *r) {
+    const SchedPolicy *pol = r->pol;
+    int n = r->tr->n;
+    const P *p = r->tr->p;
+    const int *order = r->tr->order;
+    int rc = -1;
+
+    Smp s;
+    s.r = r;
+    s.ncpu = r->prm.cpus;
+    s.nq = r->prm.balance == SCHED_BALANCE_GLOBAL ? 1 : s.ncpu;
+    s.rq = calloc(s.nq, sizeof *s.rq);
+    s.qlen = calloc(s.nq, sizeof *s.qlen);
+    s.cpu = calloc(s.ncpu, sizeof *s.cpu);
+    s.lastcpu = malloc((n ? n : 1) * sizeof *s.lastcpu);
+    char *hit = calloc(s.nq, 1);                    // Queues that received an arrival
+    int *pend = malloc(s.ncpu * 3 * sizeof *pend);  // (cpu, process, ran) of expired slices
+    int nq_ready = 0;
+    if (!s.rq || !s.qlen || !s.cpu || !s.lastcpu || !hit || !pend) goto out;
+
+    for (int q = 0; q < s.nq; q++, nq_ready++) {
+        s.rq[q] = *r;
+        if (pol->init(&s.rq[q]) != 0) goto out;
+    }
+    for (int c = 0; c < s.ncpu; c++) {
+        s.cpu[c].queue = s.nq == 1 ? 0 : c;
+        s.cpu[c].running = s.cpu[c].last = -1;
+    }
+    for (int i = 0; i < n; i++) s.lastcpu[i] = -1;
+
+    int done = 0, next = 0;
+    long long t = 0;
+
+    while (done < n) {
+        for (int q = 0; q < s.nq; q++) s.rq[q].t = t;
+
+        // 1. Slices that end now: completions, and expired slices held back
+        //    so that processes arriving at the same instant queue first
+        int npend = 0;
+        for (int c = 0; c < s.ncpu; c++) {
+            if (s.cpu[c].running < 0 || s.cpu[c].end != t) continue;
+            int k = s.cpu[c].running;
+            int ran = smp_stop(&s, c, t);
+            if (r->rt[k] == 0) {
+                r->ct[k] = t;
+                done++;
+            } else {
+                pend[3 * npend] = c;
+                pend[3 * npend + 1] = k;
+                pend[3 * npend + 2] = ran;
+                npend++;
+            }
+        }
+
+        // 2. Arrivals
+        memset(hit, 0, s.nq);
+        while (next < n && p[order[next]].at <= t) {
+            int q = smp_place(&s);
+            smp_enqueue(&s, q, order[next++], 0, 0);
+            hit[q] = 1;
+        }
+
+        // 3. Re-queue the expired slices on their own CPU's queue
+        for (int i = 0; i < npend; i++) {
+            int c = pend[3 * i];
+            smp_enqueue(&s, s.cpu[c].queue, pend[3 * i + 1], pend[3 * i + 2], 1);
+        }
+
+        // 4. Preemptive policies re-decide on the queues that got arrivals
+        if (pol->preempt_on_arrival) {
+            for (int c = 0; c < s.ncpu; c++) {
+                Cpu *cpu = &s.cpu[c];
+                if (cpu->running < 0 || !hit[cpu->queue] || cpu->start >= t) continue;
+                int k = cpu->running;
+                int ran = smp_stop(&s, c, t);
+                smp_enqueue(&s, cpu->queue, k, ran, 1);
+            }
+        }
+
+        // 5. Fill idle CPUs
+        smp_dispatch(&s, t);
+
+        // 6. Advance to the next event
+        long long next_t = -1;
+        for (int c = 0; c < s.ncpu; c++) {
+            if (s.cpu[c].running >= 0 && (next_t < 0 || s.cpu[c].end < next_t)) next_t = s.cpu[c].end;
+        }
+        if (next < n && (next_t < 0 || p[order[next]].at < next_t)) next_t = p[order[next]].at;
+        if (next_t < 0) break; // Nothing left to happen (only reached if n == done)
+        t = next_t;
+    }
+
+    r->t = t;
+    rc = 0;
+out:
+    for (int q = 0; q < nq_ready; q++) pol->destroy(&s.rq[q]);
+    free(s.rq);
+    free(s.qlen);
+    free(s.cpu);
+    free(s.lastcpu);
+    free(hit);
+    free(pend);
+    return rc;
+}
+
+int sched_run(SchedRun *r, const SchedTrace *tr, const SchedPolicy *pol, const SchedParams *prm) {
+    return sched_run_traced(r, tr, pol, prm, NULL);
+}
+
+int sched_run_traced(SchedRun *r, const SchedTrace *tr, const SchedPolicy *pol, const SchedParams *prm,
+                     SchedTimeline *tl) {
+    struct timespec t0, t1;
+
+    if (run_alloc(r, tr, pol, prm) != 0) return -1;
+    r->timeline = tl;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int rc = r->prm.cpus > 1 ? run_smp(r) : run_uniprocessor(r);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    r->elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    if (tl) timeline_flush(tl);
+    if (rc != 0) sched_run_free(r);
+    return rc;
+}
+
+void sched_run_free(SchedRun *r) {
+    free(r->rt);
+    free(r->ct);
+    free(r->st);
+    free(r->key);
+    free(r->cpu_busy);
+    r->rt = NULL;
+    r->ct = NULL;
+    r->st = NULL;
+    r->key = NULL;
+    r->cpu_busy = NULL;
+}
+
+// ===================================================================
+// Metrics and output
+// ===================================================================
+
+// --- Streaming quantile sketch ---
+// A log-linear histogram: values below 2^(SKETCH_BITS+1) get a bucket each
+// (so small traces are exact), larger values share 2^SKETCH_BITS buckets per
+// power of two, bounding the relative error to 2^-SKETCH_BITS (under 1%).
+// Memory is fixed, however many jobs are added.
+#define SKETCH_BITS 7
+#define SKETCH_SUB (1 << SKETCH_BITS)
+#define SKETCH_BUCKETS ((64 - SKETCH_BITS) * SKETCH_SUB)
+
+typedef struct {
+    long long count[SKETCH_BUCKETS];
+    long long n;
+    long long max;
+    double sum;
+} Sketch;
+
+static int sketch_bucket(long long v) {
+    if (v < SKETCH_SUB) return (int)v;
+    int shift = 63 - __builtin_clzll(v) - SKETCH_BITS;
+    return (shift + 1) * SKETCH_SUB + (int)((v >> shift) - SKETCH_SUB);
+}
+
+// Midpoint of the range of values that fall into bucket b
+static long long sketch_value(int b) {
+    if (b < 2 * SKETCH_SUB) return b;
+    int shift = b / SKETCH_SUB - 1;
+    long long low = (long long)(b % SKETCH_SUB + SKETCH_SUB) << shift;
+    return low + ((1LL << shift) - 1) / 2;
+}
+
+static void sketch_add(Sketch *s, long long v) {
+    if (v < 0) v = 0;
+    s->count[sketch_bucket(v)]++;
+    s->n++;
+    s->sum += v;
+    if (v > s->max) s->max = v;
+}
+
+// Nearest-rank quantile, q in (0, 1]
+static long long sketch_quantile(const Sketch *s, double q) {
+    long long rank = (long long)(q * s->n + 0.999999);
+    long long seen = 0;
+    if (rank < 1) rank = 1;
+    for (int b = 0; b < SKETCH_BUCKETS; b++) {
+        seen += s->count[b];
+        if (seen >= rank) {
+            long long v = sketch_value(b);
+            return v < s->max ? v : s->max;
+        }
+    }
+    return s->max;
+}
+
+static void sketch_summarize(const Sketch *s, SchedDist *d) {
+    d->mean = s->n ? s->sum / s->n : 0;
+    d->p50 = sketch_quantile(s, 0.50);
+    d->p90 = sketch_quantile(s, 0.90);
+    d->p99 = sketch_quantile(s, 0.99);
+    d->p999 = sketch_quantile(s, 0.999);
+    d->max = s->max;
+}
+
+void sched_metrics(const SchedRun *r, SchedMetrics *m) {
+    const SchedTrace *tr = r->tr;
+    long long makespan = 0;
+    Sketch *sk = calloc(3, sizeof *sk); // Waiting, turnaround and response time
+
+    memset(m, 0, sizeof *m);
+    for (int i = 0; i < tr->n; i++) {
+        long long tat = r->ct[i] - tr->p[i].at; // Turnaround Time (TAT)
+        long long wt = tat - tr->p[i].bt;       // Waiting Time (WT)
+        long long rsp = r->st[i] - tr->p[i].at; // Response Time (first run - AT)
+        if (r->ct[i] > makespan) makespan = r->ct[i];
+        if (sk) {
+            sketch_add(&sk[0], wt);
+            sketch_add(&sk[1], tat);
+            sketch_add(&sk[2], rsp);
+        }
+    }
+
+    if (sk) {
+        sketch_summarize(&sk[0], &m->wt);
+        sketch_summarize(&sk[1], &m->tat);
+        sketch_summarize(&sk[2], &m->rsp);
+        free(sk);
+    }
+    m->jobs = tr->n;
+    m->makespan = makespan;
+    m->switches = r->switches;
+    m->migrations = r->migrations;
+    m->elapsed = r->elapsed;
+    m->utilization = makespan ? (double)r->busy / ((double)makespan * r->prm.cpus) : 0;
+    m->throughput = makespan ? (double)tr->n / makespan : 0;
+}
+
+// Function to print the scheduling results table (in input order)
+void print_results(FILE *out, const SchedRun *r, const SchedMetrics *m) {
+    const SchedTrace *tr = r->tr;
+
+    fprintf(out, "\n--- Scheduling Results ---\n");
+    fprintf(out, "+----+-----+-----+-----+-----+-----+\n");
+    fprintf(out, "| ID | AT  | BT  | CT  | TAT | WT  |\n");
+    fprintf(out, "+----+-----+-----+-----+-----+-----+\n");
+
+    for (int i = 0; i < tr->n; i++) {
+        const P *q = &tr->p[i];
+        long long tat = r->ct[i] - q->at;
+        fprintf(out, "| %2d | %3d | %3d | %3lld | %3lld | %3lld |\n",
+                q->id, q->at, q->bt, r->ct[i], tat, tat - q->bt);
+    }
+    fprintf(out, "+----+-----+-----+-----+-----+-----+\n");
+    print_summary(out, r, m);
+}
+
+static void print_dist(FILE *out, const char *label, const SchedDist *d) {
+    fprintf(out, "%-16s p50 %lld | p90 %lld | p99 %lld | p99.9 %lld | max %lld\n",
+            label, d->p50, d->p90, d->p99, d->p999, d->max);
+}
+
+// The averages and tail latencies printed under the table (also used on
+// their own with -s)
+void print_summary(FILE *out, const SchedRun *r, const SchedMetrics *m) {
+    fprintf(out, "Average Waiting Time:    %.2f\n", m->wt.mean);
+    fprintf(out, "Average Turnaround Time: %.2f\n", m->tat.mean);
+    fprintf(out, "Average Response Time:   %.2f\n", m->rsp.mean);
+    print_dist(out, "Waiting Time:", &m->wt);
+    print_dist(out, "Turnaround Time:", &m->tat);
+    print_dist(out, "Response Time:", &m->rsp);
+    fprintf(out, "CPU Utilization:         %.2f%%\n", 100.0 * m->utilization);
+    fprintf(out, "Throughput:              %.6f jobs/unit\n", m->throughput);
+    fprintf(out, "Context Switches:        %lld", m->switches);
+    if (r->prm.switch_cost > 0) {
+        fprintf(out, " (overhead %lld)", m->switches * r->prm.switch_cost);
+    }
+    fprintf(out, "\n");
+    if (r->prm.cpus > 1) {
+        static const char *const balance_names[] = { "global queue", "per-CPU queues", "work stealing" };
+        fprintf(out, "CPUs:                    %d (%s)\n", r->prm.cpus, balance_names[r->prm.balance]);
+        fprintf(out, "Migrations:              %lld\n", r->migrations);
+        if (r->prm.balance == SCHED_BALANCE_STEAL) {
+            fprintf(out, "Steals:                  %lld\n", r->steals);
+        }
+        fprintf(out, "Per-CPU Utilization:");
+        for (int c = 0; c < r->prm.cpus; c++) {
+            fprintf(out, "%s cpu%d %.1f%%", (c % 8 == 0 && c > 0) ? "\n                   " : "",
+                    c, m->makespan ? 100.0 * r->cpu_busy[c] / m->makespan : 0.0);
+        }
+        fprintf(out, "\n");
+    }
+    fprintf(out, "---------------------------\n");
+}
+
+// Simulator speed: jobs simulated per second of wall-clock time
+static double sim_rate(const SchedMetrics *m) {
+    return m->elapsed > 0 ? m->jobs / m->elapsed : 0;
+}
+
+// --- Machine-readable output: one record per (policy, parameters) run ---
+void print_csv_header(FILE *out) {
+    fprintf(out, "policy,quantum,switch_cost,cpus,balance,jobs,makespan,utilization,throughput,"
+                 "switches,migrations,sim_seconds,jobs_per_sec");
+    static const char *const dists[] = { "wt", "tat", "rsp" };
+    for (int i = 0; i < 3; i++) {
+        fprintf(out, ",%s_mean,%s_p50,%s_p90,%s_p99,%s_p999,%s_max",
+                dists[i], dists[i], dists[i], dists[i], dists[i], dists[i]);
+    }
+    fprintf(out, "\n");
+}
+
+void print_csv_row(FILE *out, const SchedPolicy *pol, const SchedParams *prm, const SchedMetrics *m) {
+    const SchedDist *d[3] = { &m->wt, &m->tat, &m->rsp };
+    fprintf(out, "%s,%d,%d,%d,%d,%lld,%lld,%.6f,%.6f,%lld,%lld,%.6f,%.0f",
+            pol->name, prm->quantum, prm->switch_cost, prm->cpus, prm->balance,
+            m->jobs, m->makespan, m->utilization, m->throughput, m->switches, m->migrations,
+            m->elapsed, sim_rate(m));
+    for (int i = 0; i < 3; i++) {
+        fprintf(out, ",%.3f,%lld,%lld,%lld,%lld,%lld",
+                d[i]->mean, d[i]->p50, d[i]->p90, d[i]->p99, d[i]->p999, d[i]->max);
+    }
+    fprintf(out, "\n");
+}
+
+// One JSON object; the caller writes the enclosing array and separators
+void print_json(FILE *out, const SchedPolicy *pol, const SchedParams *prm, const SchedMetrics *m) {
+    static const char *const names[3] = { "wt", "tat", "rsp" };
+    const SchedDist *d[3] = { &m->wt, &m->tat, &m->rsp };
+
+    fprintf(out, "  {\"policy\": \"%s\", \"quantum\": %d, \"switch_cost\": %d, \"cpus\": %d, "
+                 "\"balance\": %d, \"jobs\": %lld, \"makespan\": %lld, \"utilization\": %.6f, "
+                 "\"throughput\": %.6f, \"switches\": %lld, \"migrations\": %lld, "
+                 "\"sim_seconds\": %.6f, \"jobs_per_sec\": %.0f",
+            pol->name, prm->quantum, prm->switch_cost, prm->cpus, prm->balance,
+            m->jobs, m->makespan, m->utilization, m->throughput, m->switches, m->migrations,
+            m->elapsed, sim_rate(m));
+    for (int i = 0; i < 3; i++) {
+        fprintf(out, ", \"%s\": {\"mean\": %.3f, \"p50\": %lld, \"p90\": %lld, \"p99\": %lld, "
+                     "\"p99.9\": %lld, \"max\": %lld}",
+                names[i], d[i]->mean, d[i]->p50, d[i]->p90, d[i]->p99, d[i]->p999, d[i]->max);
+    }
+    fprintf(out, "}");
+}
+
+int sched_simulate(const SchedTrace *tr, const SchedPolicy *pol, const SchedParams *prm) {
+    SchedRun r;
+    SchedMetrics m;
+
+    if (sched_run(&r, tr, pol, prm) != 0) {
+        printf("Memory allocation failed.\n");
+        return -1;
+    }
+    sched_metrics(&r, &m);
+    print_results(stdout, &r, &m);
+    sched_run_free(&r);
+    return 0;
+}
+
+static void comparison_header(FILE *out, const SchedParams *prm) {
+    fprintf(out, "\n--- Policy Comparison (RR q=%d, switch cost=%d) ---\n",
+            prm->quantum, prm->switch_cost);
+    fprintf(out, "+--------+--------------+------------+--------------+--------------+---------+------------+\n");
+    fprintf(out, "| Policy |    Avg WT    |   P99 WT   |   Avg TAT    |    Avg RT    |  Util   |  Switches  |\n");
+    fprintf(out, "+--------+--------------+------------+--------------+--------------+---------+------------+\n");
+}
+
+static void comparison_row(FILE *out, const SchedPolicy *pol, const SchedMetrics *m) {
+    fprintf(out, "| %-6s | %12.2f | %10lld | %12.2f | %12.2f | %6.2f%% | %10lld |\n",
+            pol->name, m->wt.mean, m->wt.p99, m->tat.mean, m->rsp.mean,
+            100.0 * m->utilization, m->switches);
+}
+
+static void comparison_footer(FILE *out) {
+    fprintf(out, "+--------+--------------+------------+--------------+--------------+---------+------------+\n");
+}
+
+void sched_compare(const SchedTrace *tr, const SchedParams *prm) {
+    comparison_header(stdout, prm);
+    for (int i = 0; i < SCHED_NUM_POLICIES; i++) {
+        SchedRun r;
+        SchedMetrics m;
+        if (sched_run(&r, tr, SCHED_POLICIES[i], prm) != 0) {
+            printf("Memory allocation failed.\n");
+            return;
+        }
+        sched_metrics(&r, &m);
+        comparison_row(stdout, SCHED_POLICIES[i], &m);
+        sched_run_free(&r);
+    }
+    comparison_footer(stdout);
+}
+
+// ===================================================================
+// Parameter sweep
+// ===================================================================
+
+// Workers share the trace (read-only) and claim grid cells in order
+typedef struct {
+    const SchedTrace *tr;
+    SchedSweepJob *jobs;
+    int njobs;
+    int next; // Next unclaimed cell (atomic)
+} Sweep;
+
+static void *sweep_worker(void *arg) {
+    Sweep *sw = arg;
+    int i;
+    while ((i = __atomic_fetch_add(&sw->next, 1, __ATOMIC_RELAXED)) < sw->njobs) {
+        SchedSweepJob *job = &sw->jobs[i];
+        SchedRun r;
+        job->rc = sched_run(&r, sw->tr, job->pol, &job->prm);
+        if (job->rc == 0) {
+            sched_metrics(&r, &job->m);
+            sched_run_free(&r);
+        }
+    }
+    return NULL;
+}
+
+int sched_sweep(const SchedTrace *tr, SchedSweepJob *jobs, int njobs, int threads) {
+    Sweep sw = { tr, jobs, njobs, 0 };
+    pthread_t tid[SCHED_MAX_SWEEP_THREADS];
+    int started = 0;
+
+    if (threads > njobs) threads = njobs;
+    if (threads > SCHED_MAX_SWEEP_THREADS) threads = SCHED_MAX_SWEEP_THREADS;
+    // The calling thread is the last worker; if a thread can't be created
+    // the remaining ones simply take more cells each
+    while (started < threads - 1 && pthread_create(&tid[started], NULL, sweep_worker, &sw) == 0) {
+        started++;
+    }
+    sweep_worker(&sw);
+    for (int i = 0; i < started; i++) pthread_join(tid[i], NULL);
+
+    for (int i = 0; i < njobs; i++) {
+        if (jobs[i].rc != 0) return -1;
+    }
+    return 0;
+}
+
+static void sweep_header(FILE *out, int njobs, int threads, double secs, const SchedParams *prm) {
+    fprintf(out, "\n--- Parameter Sweep (%d runs on %d threads in %.2fs, switch cost=%d) ---\n",
+            njobs, threads, secs, prm->switch_cost);
+    fprintf(out, "+--------+---------+--------------+------------+--------------+--------------+---------+------------+\n");
+    fprintf(out, "| Policy | Quantum |    Avg WT    |   P99 WT   |   Avg TAT    |    Avg RT    |  Util   |  Switches  |\n");
+    fprintf(out, "+--------+---------+--------------+------------+--------------+--------------+---------+------------+\n");
+}
+
+static void sweep_row(FILE *out, const SchedSweepJob *job) {
+    const SchedMetrics *m = &job->m;
+    char quantum[16] = "-";
+    if (job->pol->uses_quantum) snprintf(quantum, sizeof quantum, "%d", job->prm.quantum);
+    fprintf(out, "| %-6s | %7s | %12.2f | %10lld | %12.2f | %12.2f | %6.2f%% | %10lld |\n",
+            job->pol->name, quantum, m->wt.mean, m->wt.p99, m->tat.mean, m->rsp.mean,
+            100.0 * m->utilization, m->switches);
+}
+
+static void sweep_footer(FILE *out) {
+    fprintf(out, "+--------+---------+--------------+------------+--------------+--------------+---------+------------+\n");
+}
+
+// ===================================================================
+// Batch (non-interactive) mode
+// ===================================================================
+
+static void batch_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s -f TRACE [-p POLICIES] [-q QUANTUM[,...]] [-j THREADS] [-c COST] [-n CPUS]\n"
+            "          [-b BALANCE] [-a AGING] [-m QUANTA] [-r PERIOD] [-o OUT] [-s] [-F FORMAT] [-t TIMELINE]\n"
+            "       %s -f TRACE -B OUT.bin\n"
+            "  -f TRACE     text trace (one \"AT BT [PRIO]\" per line, '#' comments) or binary trace\n"
+            "  -p POLICIES  comma-separated list of policies or \"all\" (default: this program's)\n"
+            "  -q QUANTUM   Round Robin time quantum (default 2); a list such as 1,2,4,8 sweeps\n"
+            "               every policy over every quantum and prints one comparison table\n"
+            "  -j THREADS   run the sweep on THREADS threads (default: one per online CPU)\n"
+            "  -c COST      context-switch cost (default 0)\n"
+            "  -n CPUS      simulate CPUS processors (default 1)\n"
+            "  -b BALANCE   SMP load balancing: global, percpu or steal (default global)\n"
+            "  -a AGING     priority aging: waiting time worth one priority level (default 0 = off)\n"
+            "  -m QUANTA    MLFQ quantum per level, top level first (default 2,4,8)\n"
+            "  -r PERIOD    MLFQ priority boost period (default 100, 0 = off)\n"
+            "  -o OUT       write results to OUT instead of stdout\n"
+            "  -s           summary only: skip the per-process table\n"
+            "  -F FORMAT    output format: table, csv or json (default table)\n"
+            "  -t TIMELINE  record the execution timeline: Chrome trace-event JSON if the name\n"
+            "               ends in .json (open it in chrome://tracing or Perfetto), binary otherwise\n"
+            "  -B OUT.bin   convert TRACE to the binary trace format and exit\n",
+            prog, prog);
+}
+
+enum { FORMAT_TABLE, FORMAT_CSV, FORMAT_JSON };
+
+#define MAX_SWEEP_QUANTA 64
+
+// Parse a list of positive numbers such as "2,4,8"; returns the count or -1
+static int parse_int_list(const char *list, int v[], int max) {
+    int count = 0;
+    while (*list) {
+        char *end;
+        long q = strtol(list, &end, 10);
+        if (end == list || q <= 0 || q > INT32_MAX || count == max) return -1;
+        v[count++] = (int)q;
+        list = end;
+        if (*list == ',') list++;
+        else if (*list) return -1;
+    }
+    return count > 0 ? count : -1;
+}
+
+// Parse "fcfs,rr" / "all" into 'pols'; returns the count or -1 on error
+static int parse_policy_list(const char *list, const SchedPolicy *pols[], int max) {
+    if (strcmp(list, "all") == 0) {
+        for (int i = 0; i < SCHED_NUM_POLICIES && i < max; i++) pols[i] = SCHED_POLICIES[i];
+        return SCHED_NUM_POLICIES < max ? SCHED_NUM_POLICIES : max;
+    }
+
+    int count = 0;
+    char name[32];
+    while (*list) {
+        size_t len = strcspn(list, ",");
+        if (len == 0 || len >= sizeof name || count == max) return -1;
+        memcpy(name, list, len);
+        name[len] = '\0';
+        if (!(pols[count++] = sched_policy_by_name(name))) {
+            fprintf(stderr, "Unknown policy \"%s\"\n", name);
+            return -1;
+        }
+        list += len;
+        if (*list == ',') list++;
+    }
+    return count;
+}
+
+// Run the policies x quanta grid in parallel and print one table (or one
+// record per cell); returns the exit status
+static int batch_sweep(FILE *out, const SchedTrace *tr, const SchedPolicy *const pols[], int npols,
+                       const int quanta[], int nquanta, const SchedParams *prm, int threads, int format) {
+    struct timespec t0, t1;
+    int njobs = 0;
+    SchedSweepJob *jobs = malloc(npols * (nquanta > 0 ? nquanta : 1) * sizeof *jobs);
+
+    if (!jobs) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return 1;
+    }
+    // Policies that never look at the quantum get a single cell
+    for (int i = 0; i < npols; i++) {
+        int cells = pols[i]->uses_quantum && nquanta > 0 ? nquanta : 1;
+        for (int j = 0; j < cells; j++) {
+            jobs[njobs].pol = pols[i];
+            jobs[njobs].prm = *prm;
+            if (pols[i]->uses_quantum && nquanta > 0) jobs[njobs].prm.quantum = quanta[j];
+            njobs++;
+        }
+    }
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+    if (threads > njobs) threads = njobs;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (sched_sweep(tr, jobs, njobs, threads) != 0) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        free(jobs);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (format == FORMAT_CSV) {
+        print_csv_header(out);
+        for (int i = 0; i < njobs; i++) print_csv_row(out, jobs[i].pol, &jobs[i].prm, &jobs[i].m);
+    } else if (format == FORMAT_JSON) {
+        fprintf(out, "[\n");
+        for (int i = 0; i < njobs; i++) {
+            if (i > 0) fprintf(out, ",\n");
+            print_json(out, jobs[i].pol, &jobs[i].prm, &jobs[i].m);
+        }
+        fprintf(out, "\n]\n");
+    } else {
+        sweep_header(out, njobs, threads,
+                     (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9, prm);
+        for (int i = 0; i < njobs; i++) sweep_row(out, &jobs[i]);
+        sweep_footer(out);
+    }
+    free(jobs);
+    return 0;
+}
+
+int sched_batch_main(int argc, char *argv[], const SchedPolicy *const defaults[], int ndefaults) {
+    const char *trace_path = NULL, *out_path = NULL, *bin_path = NULL, *timeline_path = NULL;
+    const SchedPolicy *pols[SCHED_MAX_BATCH_POLICIES];
+    int npols = 0;
+    int summary_only = 0;
+    int format = FORMAT_TABLE;
+    int quanta[MAX_SWEEP_QUANTA];
+    int nquanta = 0;
+    int threads = 0; // 0 = not a sweep unless several quanta are given
+    SchedParams prm;
+    int opt;
+
+    sched_params_init(&prm);
+
+    for (int i = 0; i < ndefaults && i < SCHED_MAX_BATCH_POLICIES; i++) pols[npols++] = defaults[i];
+
+    while ((opt = getopt(argc, argv, "f:p:q:j:c:n:b:a:m:r:o:sF:t:B:h")) != -1) {
+        switch (opt) {
+            case 'f': trace_path = optarg; break;
+            case 'o': out_path = optarg; break;
+            case 'B': bin_path = optarg; break;
+            case 't': timeline_path = optarg; break;
+            case 's': summary_only = 1; break;
+            case 'F':
+                if (strcmp(optarg, "table") == 0) {
+                    format = FORMAT_TABLE;
+                } else if (strcmp(optarg, "csv") == 0) {
+                    format = FORMAT_CSV;
+                } else if (strcmp(optarg, "json") == 0) {
+                    format = FORMAT_JSON;
+                } else {
+                    fprintf(stderr, "Unknown output format \"%s\"\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'p':
+                npols = parse_policy_list(optarg, pols, SCHED_MAX_BATCH_POLICIES);
+                if (npols <= 0) {
+                    batch_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'q':
+                nquanta = parse_int_list(optarg, quanta, MAX_SWEEP_QUANTA);
+                if (nquanta <= 0) {
+                    fprintf(stderr, "Quanta must be 1-%d positive numbers, e.g. 2 or 1,2,4,8.\n",
+                            MAX_SWEEP_QUANTA);
+                    return 1;
+                }
+                prm.quantum = quanta[0];
+                break;
+            case 'j':
+                threads = atoi(optarg);
+                if (threads <= 0 || threads > SCHED_MAX_SWEEP_THREADS) {
+                    fprintf(stderr, "Thread count must be between 1 and %d.\n", SCHED_MAX_SWEEP_THREADS);
+                    return 1;
+                }
+                break;
+            case 'c':
+                prm.switch_cost = atoi(optarg);
+                if (prm.switch_cost < 0) {
+                    fprintf(stderr, "Context-switch cost must be non-negative.\n");
+                    return 1;
+                }
+                break;
+            case 'a':
+                prm.prio_aging = atoi(optarg);
+                if (prm.prio_aging < 0) {
+                    fprintf(stderr, "Aging interval must be non-negative.\n");
+                    return 1;
+                }
+                break;
+            case 'm':
+                prm.mlfq_levels = parse_int_list(optarg, prm.mlfq_quantum, SCHED_MLFQ_MAX_LEVELS);
+                if (prm.mlfq_levels <= 0) {
+                    fprintf(stderr, "MLFQ quanta must be 1-%d positive numbers, e.g. 2,4,8.\n",
+                            SCHED_MLFQ_MAX_LEVELS);
+                    return 1;
+                }
+                break;
+            case 'r':
+                prm.mlfq_boost = atoi(optarg);
+                if (prm.mlfq_boost < 0) {
+                    fprintf(stderr, "Boost period must be non-negative.\n");
+                    return 1;
+                }
+                break;
+            case 'n':
+                prm.cpus = atoi(optarg);
+                if (prm.cpus <= 0 || prm.cpus > SCHED_MAX_CPUS) {
+                    fprintf(stderr, "CPU count must be between 1 and %d.\n", SCHED_MAX_CPUS);
+                    return 1;
+                }
+                break;
+            case 'b':
+                if (strcmp(optarg, "global") == 0) {
+                    prm.balance = SCHED_BALANCE_GLOBAL;
+                } else if (strcmp(optarg, "percpu") == 0) {
+                    prm.balance = SCHED_BALANCE_PERCPU;
+                } else if (strcmp(optarg, "steal") == 0) {
+                    prm.balance = SCHED_BALANCE_STEAL;
+                } else {
+                    fprintf(stderr, "Unknown balancing mode \"%s\"\n", optarg);
+                    return 1;
+                }
+                break;
+            default:
+                batch_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (!trace_path || optind != argc) {
+        batch_usage(argv[0]);
+        return 1;
+    }
+    if (timeline_path && (nquanta > 1 || threads > 0)) {
+        fprintf(stderr, "A timeline can't be recorded during a parameter sweep.\n");
+        return 1;
+    }
+
+    SchedTrace tr;
+    if (sched_trace_load(&tr, trace_path) != 0) {
+        return 1;
+    }
+
+    if (bin_path) {
+        int rc = sched_trace_write_binary(&tr, bin_path);
+        sched_trace_free(&tr);
+        return rc == 0 ? 0 : 1;
+    }
+
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        perror(out_path);
+        sched_trace_free(&tr);
+        return 1;
+    }
+    // Results go out in large chunks rather than a write per table row
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+    if (nquanta > 1 || threads > 0) {
+        int rc = batch_sweep(out, &tr, pols, npols, quanta, nquanta, &prm, threads, format);
+        if (out != stdout) {
+            if (fclose(out) != 0) {
+                perror(out_path);
+                rc = 1;
+            }
+        } else {
+            fflush(out);
+        }
+        sched_trace_free(&tr);
+        return rc;
+    }
+
+    SchedTimeline *tl = NULL;
+    if (timeline_path) {
+        size_t len = strlen(timeline_path);
+        int chrome = len >= 5 && strcmp(timeline_path + len - 5, ".json") == 0;
+        tl = sched_timeline_open(timeline_path, chrome ? SCHED_TIMELINE_CHROME : SCHED_TIMELINE_BINARY);
+        if (!tl) {
+            if (out != stdout) fclose(out);
+            sched_trace_free(&tr);
+            return 1;
+        }
+    }
+
+    SchedMetrics m[SCHED_MAX_BATCH_POLICIES];
+    int rc = 0;
+    if (format == FORMAT_CSV) print_csv_header(out);
+    if (format == FORMAT_JSON) fprintf(out, "[\n");
+    for (int i = 0; i < npols; i++) {
+        SchedRun r;
+        if (tl) sched_timeline_begin(tl, pols[i]->title, prm.cpus);
+        if (sched_run_traced(&r, &tr, pols[i], &prm, tl) != 0) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            rc = 1;
+            break;
+        }
+        sched_metrics(&r, &m[i]);
+        if (format == FORMAT_CSV) {
+            print_csv_row(out, pols[i], &prm, &m[i]);
+        } else if (format == FORMAT_JSON) {
+            if (i > 0) fprintf(out, ",\n");
+            print_json(out, pols[i], &prm, &m[i]);
+        } else if (summary_only) {
+            fprintf(out, "\n*** Policy: %s ***\n", pols[i]->title);
+            print_summary(out, &r, &m[i]);
+        } else {
+            fprintf(out, "\n*** Policy: %s ***\n", pols[i]->title);
+            print_results(out, &r, &m[i]);
+        }
+        if (format == FORMAT_TABLE) {
+            fprintf(out, "Simulated in %.3fs (%.0f jobs/s)\n", m[i].elapsed, sim_rate(&m[i]));
+        }
+        sched_run_free(&r);
+    }
+
+    if (format == FORMAT_JSON) fprintf(out, "\n]\n");
+    if (rc == 0 && npols > 1 && format == FORMAT_TABLE) {
+        comparison_header(out, &prm);
+        for (int i = 0; i < npols; i++) comparison_row(out, pols[i], &m[i]);
+        comparison_footer(out);
+    }
+
+    if (tl && sched_timeline_close(tl) != 0) {
+        perror(timeline_path);
+        rc = 1;
+    }
+    if (out != stdout) {
+        if (fclose(out) != 0) {
+            perror(out_path);
+            rc = 1;
+        }
+    } else {
+        fflush(out);
+    }
+    sched_trace_free(&tr);
+    return rc;
+}
@@ -0,0 +1,228 @@
+// scheduler.h — CPU scheduling library shared by 3.1.c, 3.2.c and 3.3.c
+//
+// One event-driven loop (sched_run) drives every policy through a small vtable.
+// The trace is sorted once and never modified while simulating, so any number
+// of policies can be run (and compared) against a single load.
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// --- Input: one process of the trace ---
+typedef struct {
+    int id;   // Original index/ID
+    int at;   // Arrival Time
+    int bt;   // Burst Time
+    int prio; // Priority (lower value = more important; used by "prio")
+} P;
+
+// --- Input: the whole trace (read-only while simulating) ---
+typedef struct {
+    P *p;       // Processes in input order (p[i].id == i)
+    int *order; // Indices into p sorted by (AT, ID); filled by sched_trace_sort()
+    int n;      // Number of processes
+    int cap;    // Allocated capacity of p
+} SchedTrace;
+
+// --- Binary trace file layout ---
+// A 16-byte header followed by 'count' records of 'fields' host-endian int32
+// values: AT, BT, PRIO, then any extra columns (ignored by this reader).
+// Two-field files (no PRIO) are accepted with every priority 0.
+#define SCHED_TRACE_MAGIC "SCHT"
+
+typedef struct {
+    char magic[4];   // SCHED_TRACE_MAGIC
+    uint32_t fields; // int32 values per record (>= 2)
+    uint64_t count;  // Number of records
+} SchedTraceHeader;
+
+// --- Load balancing between CPUs (SMP runs only) ---
+enum {
+    SCHED_BALANCE_GLOBAL, // One run queue shared by all CPUs
+    SCHED_BALANCE_PERCPU, // A run queue per CPU; arrivals go to the least loaded one
+    SCHED_BALANCE_STEAL   // Per-CPU queues, and idle CPUs steal from the longest queue
+};
+
+#define SCHED_MAX_CPUS 1024
+#define SCHED_MLFQ_MAX_LEVELS 8
+
+// --- Tunables shared by all policies ---
+typedef struct {
+    int quantum;     // Time slice for RR
+    int switch_cost; // CPU time lost every time a different process is dispatched
+    int cpus;        // Number of CPUs simulated (0 or 1 = uniprocessor)
+    int balance;     // SCHED_BALANCE_* (ignored on a uniprocessor)
+    int prio_aging;  // Priority: waiting time worth one priority level (0 = no aging)
+    int mlfq_levels; // MLFQ: number of levels
+    int mlfq_quantum[SCHED_MLFQ_MAX_LEVELS]; // MLFQ: time slice per level, top first
+    int mlfq_boost;  // MLFQ: period of the boost back to the top level (0 = never)
+} SchedParams;
+
+typedef struct SchedPolicy SchedPolicy;
+
+// --- Timeline of which process ran where ---
+// Binary timeline files hold a 16-byte header followed by 'count' host-endian
+// SchedSegment records. Consecutive slices of one process on one CPU are
+// merged into a single segment.
+#define SCHED_TIMELINE_MAGIC "SCHG"
+
+typedef struct {
+    char magic[4];        // SCHED_TIMELINE_MAGIC
+    uint32_t record_size; // sizeof(SchedSegment)
+    uint64_t count;       // Number of segments
+} SchedTimelineHeader;
+
+typedef struct {
+    int64_t start;   // Segment covers [start, end)
+    int64_t end;
+    int32_t id;      // Process ID
+    uint16_t cpu;
+    uint16_t run;    // Which run of the file (one per policy in batch mode)
+} SchedSegment;
+
+enum {
+    SCHED_TIMELINE_BINARY, // SchedTimelineHeader + SchedSegment records
+    SCHED_TIMELINE_CHROME  // Chrome trace-event JSON (one time unit = 1us)
+};
+
+typedef struct SchedTimeline SchedTimeline;
+
+// --- Mutable state of one simulation run ---
+typedef struct {
+    const SchedTrace *tr;
+    const SchedPolicy *pol;
+    SchedParams prm;
+    long long t;        // Current time
+    int *rt;              // Remaining Time per process
+    long long *ct;        // Completion Time per process
+    long long *st;        // First time on a CPU per process (-1 = not yet)
+    long long *key;       // Per-process scratch key for ordered ready queues
+    long long busy;       // Time the CPUs spent running processes
+    long long *cpu_busy;  // The same, per CPU
+    long long switches;   // Number of context switches
+    long long migrations; // Times a process resumed on a different CPU
+    long long steals;     // Processes taken from another CPU's queue
+    SchedTimeline *timeline; // Where executed slices are recorded, or NULL
+    double elapsed;       // Wall-clock seconds the simulation took
+    void *state;          // Policy-private ready queue
+} SchedRun;
+
+// --- Policy interface ---
+// The loop admits arrivals through on_arrival(), asks select_next() for the
+// process to run, runs it for at most time_slice() units (0 = until it
+// finishes) and hands it back through on_preempt() if it still has work left.
+// With preempt_on_arrival set, a running process is also handed back as soon
+// as another process arrives, so the policy can re-decide.
+struct SchedPolicy {
+    const char *name;       // Short name (used on command lines)
+    const char *title;      // Human-readable name for menus and tables
+    int preempt_on_arrival;
+    int uses_quantum;       // Results depend on SchedParams.quantum (swept by -q lists)
+    int  (*init)(SchedRun *r);              // Allocate the ready queue; 0 on success
+    void (*destroy)(SchedRun *r);
+    void (*on_arrival)(SchedRun *r, int k); // Process k became ready
+    int  (*select_next)(SchedRun *r);       // Dequeue the next process, -1 if none
+    void (*on_preempt)(SchedRun *r, int k, int ran); // k lost the CPU after running 'ran'
+    int  (*time_slice)(SchedRun *r, int k);
+};
+
+// (Prefixed SCHED_POLICY_ because <sched.h> already defines SCHED_RR)
+extern const SchedPolicy SCHED_POLICY_FCFS;
+extern const SchedPolicy SCHED_POLICY_SJF;
+extern const SchedPolicy SCHED_POLICY_SRTF;
+extern const SchedPolicy SCHED_POLICY_RR;
+extern const SchedPolicy SCHED_POLICY_PRIO;
+extern const SchedPolicy SCHED_POLICY_MLFQ;
+
+// All built-in policies, in menu order
+extern const SchedPolicy *const SCHED_POLICIES[];
+extern const int SCHED_NUM_POLICIES;
+
+// --- Distribution of one per-process time (from a fixed-size sketch) ---
+typedef struct {
+    double mean;
+    long long p50, p90, p99, p999; // Percentiles (within 1% relative error)
+    long long max;
+} SchedDist;
+
+// --- Results of one metrics pass over a finished run ---
+typedef struct {
+    SchedDist wt;         // Waiting Time
+    SchedDist tat;        // Turnaround Time
+    SchedDist rsp;        // Response Time (first run - arrival)
+    long long jobs;
+    long long makespan;   // Completion time of the last process
+    long long switches;   // Context switches performed
+    long long migrations; // Times a process resumed on a different CPU
+    double utilization;   // Busy time / (makespan * CPUs)
+    double throughput;    // Jobs completed per time unit
+    double elapsed;       // Wall-clock seconds spent simulating
+} SchedMetrics;
+
+// Trace handling: all return 0 on success, -1 on allocation failure
+int  sched_trace_init(SchedTrace *tr, int cap);
+int  sched_trace_add(SchedTrace *tr, int at, int bt, int prio);
+int  sched_trace_sort(SchedTrace *tr);
+void sched_trace_free(SchedTrace *tr);
+
+// Prompt for 'n' and each process's AT/BT on stdin; returns 0 on success
+int  sched_read_processes(SchedTrace *tr);
+
+// Load a text or binary trace (detected from the magic) and sort it; errors
+// are reported on stderr and -1 is returned
+int  sched_trace_load(SchedTrace *tr, const char *path);
+int  sched_trace_write_binary(const SchedTrace *tr, const char *path);
+
+// Run 'pol' over a sorted trace; returns 0 on success, -1 on allocation failure
+int  sched_run(SchedRun *r, const SchedTrace *tr, const SchedPolicy *pol, const SchedParams *prm);
+void sched_run_free(SchedRun *r);
+
+// Timeline recording: open a file, call sched_timeline_begin() before each
+// run and pass the timeline to sched_run_traced(). Memory use does not grow
+// with the trace. open reports errors on stderr and returns NULL; close
+// returns 0 on success.
+SchedTimeline *sched_timeline_open(const char *path, int format);
+void sched_timeline_begin(SchedTimeline *tl, const char *label, int cpus);
+int  sched_run_traced(SchedRun *r, const SchedTrace *tr, const SchedPolicy *pol, const SchedParams *prm,
+                      SchedTimeline *tl);
+int  sched_timeline_close(SchedTimeline *tl);
+
+void sched_metrics(const SchedRun *r, SchedMetrics *m);
+void print_results(FILE *out, const SchedRun *r, const SchedMetrics *m);
+void print_summary(FILE *out, const SchedRun *r, const SchedMetrics *m);
+void print_csv_header(FILE *out);
+void print_csv_row(FILE *out, const SchedPolicy *pol, const SchedParams *prm, const SchedMetrics *m);
+void print_json(FILE *out, const SchedPolicy *pol, const SchedParams *prm, const SchedMetrics *m);
+
+// Run one policy and print its table; returns 0 on success
+int  sched_simulate(const SchedTrace *tr, const SchedPolicy *pol, const SchedParams *prm);
+
+// Run every built-in policy over the same trace and print one summary table
+void sched_compare(const SchedTrace *tr, const SchedParams *prm);
+
+// --- One cell of a parameter sweep ---
+typedef struct {
+    const SchedPolicy *pol; // In: policy to run
+    SchedParams prm;        // In: its parameters
+    SchedMetrics m;         // Out: filled when rc == 0
+    int rc;                 // Out: result of sched_run()
+} SchedSweepJob;
+
+#define SCHED_MAX_SWEEP_THREADS 256
+
+// Run every job on up to 'threads' threads sharing the one read-only trace;
+// returns 0 when all of them succeeded
+int  sched_sweep(const SchedTrace *tr, SchedSweepJob *jobs, int njobs, int threads);
+
+// Defaults: q=2, no switch cost, one CPU, no aging, MLFQ 2/4/8 boosted every 100
+void sched_params_init(SchedParams *prm);
+
+const SchedPolicy *sched_policy_by_name(const char *name);
+
+// Non-interactive entry point used when a program is started with arguments;
+// 'defaults' are the policies run when no -p option is given
+#define SCHED_MAX_BATCH_POLICIES 16
+int  sched_batch_main(int argc, char *argv[], const SchedPolicy *const defaults[], int ndefaults);
+
+#endif